@@ -1,33 +1,255 @@
 #include "BigInt.h"
+#include "Kernels.h"
+
+#ifndef algorithm
+#include <algorithm>
+#endif
+
+#ifndef cctype
+#include <cctype>
+#endif
+
+#ifndef cstring
+#include <cstring>
+#endif
 
 
 namespace LongMath {
+    namespace {
+        // Gives limbs of number in two's complement one by one, from lower to higher
+        // Negative number -m is ~m + 1, so carry goes up while limbs of m are zero
+        class TwosComplement {
+        public:
+            TwosComplement(const limb *m, size_t n, bool negative) :
+                    m(m), n(n), negative(negative) {}
+
+            limb next() {
+                const limb x = i < n ? m[i] : 0;
+                i++;
+                if (!negative) {
+                    return x;
+                }
+                const limb forRet = ~x + carry;
+                carry = carry && !x;
+                return forRet;
+            }
+
+        private:
+            const limb *m;
+            size_t n;
+            bool   negative;
+            size_t i     = 0;
+            limb   carry = 1;
+        };
+
+        size_t normalizedSize(const LimbArray &a) {
+            return kernels::normalizedSize(a.data(), a.size());
+        }
+
+        // Writes low bytes of limb from lower one
+        void storeBytes(uchar *dst, limb x, size_t bytes) {
+            for (size_t i = 0; i < bytes; i++) {
+                dst[i] = uchar(x >> (8 * i));
+            }
+        }
+
+        // Returns value of digit c of bases up to 36, or 36 if c is not digit
+        unsigned digitValue(int c) {
+            return std::isdigit(c) ? c - '0' : std::isalpha(c) ? (c | 0x20) - 'a' + 10 : 36;
+        }
+
+        // Base of stream from std::dec, std::hex or std::oct
+        unsigned streamBase(const std::ios_base &stream) {
+            const std::ios_base::fmtflags basefield = stream.flags() & std::ios_base::basefield;
+            return basefield == std::ios_base::hex ? 16 : basefield == std::ios_base::oct ? 8 : 10;
+        }
+
+        // Number, which is read by characters
+        struct ScannedNumber {
+            std::vector<limb> magnitude;
+            bool negative   = false;
+            bool haveDigits = false;
+            int  stop       = EOF;  // First character after number
+        };
+
+        // Reads sign and digits of base, c is first character, next() skips current character and returns next one
+        // Digits are given to RadixReader by small pieces, so string with whole number is not made
+        template <class Next>
+        ScannedNumber scanNumber(int c, Next next, unsigned base) {
+            ScannedNumber forRet;
+            if (c == '+' || c == '-') {
+                forRet.negative = c == '-';
+                c = next();
+            }
+            kernels::RadixReader reader(base);
+            char digits[4096];
+            size_t length = 0;
+            for (; c != EOF && digitValue(c) < base; c = next()) {
+                digits[length++] = char(c);
+                if (length == sizeof(digits)) {
+                    reader.append(digits, length);
+                    length = 0;
+                }
+                forRet.haveDigits = true;
+            }
+            reader.append(digits, length);
+            forRet.magnitude = reader.finish();
+            forRet.stop = c;
+            return forRet;
+        }
+
+        // Keeps lock of FILE while characters are taken by getc_unlocked
+        class FileLock {
+        public:
+            explicit FileLock(std::FILE *file) :
+                    file(file) {
+                flockfile(file);
+            }
+
+            ~FileLock() {
+                funlockfile(file);
+            }
+
+            FileLock(const FileLock&) = delete;
+            FileLock &operator=(const FileLock&) = delete;
+
+        private:
+            std::FILE *file;
+        };
+
+        // Compares magnitudes with lengths without lead zero limbs
+        int compareMagnitudes(const limb *a, size_t an, const limb *b, size_t bn) {
+            if (an != bn) {
+                return an < bn ? -1 : 1;
+            }
+            return kernels::cmp(a, b, an);
+        }
+    }
+
     // Realisation of private methods
     void BigInt::addRadix() {
-        numberArr.push_back(isNegative ? UINT8_MAX : 0);
+        numberArr.push_back(0);
     }
 
     void BigInt::purgeRadix() {
-        for (size_t i = numberArr.size() - 1; i > 0; i--) {
-            if (!numberArr[i] && !isNegative || numberArr[i] == UINT8_MAX && isNegative){
-                numberArr.pop_back();
+        while (numberArr.size() > 1 && !numberArr.back()) {
+            numberArr.pop_back();
+        }
+        // There is no negative zero
+        if (numberArr.size() == 1 && !numberArr[0]) {
+            isNegative = false;
+        }
+    }
+
+    void BigInt::negate() {
+        isNegative = !isNegative;
+        purgeRadix();
+    }
+
+    void BigInt::assignMagnitude(LimbArray &&magnitudeV, bool negative) {
+        numberArr = std::move(magnitudeV);
+        fixMagnitude(negative);
+    }
+
+    void BigInt::fixMagnitude(bool negative) {
+        if (numberArr.empty()) {
+            addRadix();
+        }
+        isNegative = negative;
+        purgeRadix();
+    }
+
+    void BigInt::addSigned(const limb *m, size_t n, bool negative) {
+        // Argument may be own magnitude, which moves if array grows
+        if (m == numberArr.data()) {
+            const LimbArray copy(m, m + n);
+            addSigned(copy.data(), n, negative);
+            return;
+        }
+
+        n = kernels::normalizedSize(m, n);
+        const size_t length = normalizedSize(numberArr);
+        if (negative == isNegative) {
+            numberArr.resize(std::max(length, n) + 1);
+            limb *const r = numberArr.data();
+            if (length >= n) {
+                r[length] = kernels::add(r, r, length, m, n);
             } else {
-                break;
+                r[n] = kernels::add(r, m, n, r, length);
+            }
+        } else {
+            numberArr.resize(std::max<size_t>(std::max(length, n), 1));
+            limb *const r = numberArr.data();
+            if (compareMagnitudes(r, length, m, n) >= 0) {
+                kernels::sub(r, r, length, m, n);
+            } else {
+                kernels::sub(r, m, n, r, length);
+                isNegative = negative;
             }
         }
+        purgeRadix();
     }
 
-    BigInt &BigInt::operator>>=(size_t shift) {
-        const size_t j(shift / UINT8_WIDTH);
-        const size_t k(shift % UINT8_WIDTH);
-        for (size_t i = 0; i < numberArr.size(); i++) {
-            const int buf = ( i + j     < numberArr.size() ? numberArr[i + j]     : isNegative ? UINT8_MAX : 0) +
-                            ((i + j + 1 < numberArr.size() ? numberArr[i + j + 1] : isNegative ? UINT8_MAX : 0)
-                                    << UINT8_WIDTH);
-            numberArr[i] = (buf >> int(k)) & UINT8_MAX;
+    // Negative number -m is ~(m - 1) in two's complement, so m - 1 is taken with complement mask
+    // Kernel works on common limbs of both numbers, rest of longer number meets sign extension of shorter one,
+    // which is 0 or LIMB_MAX, so it is only copied, complemented or filled
+    // Negative result is complement of magnitude minus one, so it is made by complement mask and one increment
+    void BigInt::applyBitwise(const BigInt &numberBI, limb (*op)(limb, limb),
+                              void (*kernel)(limb*, const limb*, const limb*, size_t, kernels::Complements)) {
+        if (&numberBI == this) {
+            const BigInt copy(numberBI);
+            applyBitwise(copy, op, kernel);
+            return;
+        }
+
+        const limb one = 1;
+        const kernels::Complements masks{isNegative ? LIMB_MAX : 0,
+                                         numberBI.isNegative ? LIMB_MAX : 0};
+        const bool negative = op(masks.a, masks.b);
+        const limb maskR = negative ? LIMB_MAX : 0;
+
+        const size_t an = normalizedSize(numberArr);
+        const size_t bn = normalizedSize(numberBI.numberArr);
+        const size_t common = std::min(an, bn);
+        numberArr.resize(std::max(an, bn) + 1);
+        limb *const r = numberArr.data();
+        if (isNegative) {
+            kernels::sub(r, r, an, &one, 1);
+        }
+        const limb *b = numberBI.numberArr.data();
+        LimbArray decremented;
+        if (numberBI.isNegative) {
+            decremented = LimbArray(b, b + bn);
+            kernels::sub(decremented.data(), decremented.data(), bn, &one, 1);
+            b = decremented.data();
+        }
+
+        kernel(r, r, b, common, {masks.a, masks.b, maskR});
+
+        // y is sign extension of shorter number, op(x, y) is constant or x ^ flip
+        const limb *const longer = an >= bn ? r : b;
+        const limb maskX = an >= bn ? masks.a : masks.b;
+        const limb y     = an >= bn ? masks.b : masks.a;
+        const limb flip  = op(0, y);
+        if (flip == op(LIMB_MAX, y)) {
+            std::fill(r + common, r + std::max(an, bn), flip ^ maskR);
+        } else {
+            for (size_t i = common; i < std::max(an, bn); i++) {
+                r[i] = longer[i] ^ maskX ^ flip ^ maskR;
+            }
         }
+        r[std::max(an, bn)] = 0;
+
+        if (negative) {
+            kernels::add(r, r, numberArr.size(), &one, 1);
+        }
+        isNegative = negative;
         purgeRadix();
-        return *this;
+    }
+
+    limb BigInt::lowLimb() const {
+        const limb low = numberArr.empty() ? 0 : numberArr[0];
+        return isNegative ? ~low + 1 : low;
     }
 
     //
@@ -37,17 +259,24 @@ namespace LongMath {
     // Constructors
     BigInt::BigInt() = default;
 
-    BigInt::BigInt(int numberInt) {
-        isNegative = (numberInt >> (INT32_WIDTH - 1)) & 1;
+    BigInt::BigInt(std::pmr::memory_resource *resource) :
+            numberArr(resource) {
+        addRadix();
+    }
 
-        for (size_t i = 0; i < sizeof(int); i++){
-            numberArr.push_back((numberInt >> (i * UINT8_WIDTH)) & UINT8_MAX);
-        }
+    BigInt::BigInt(int numberInt, std::pmr::memory_resource *resource) :
+            numberArr(resource) {
+        isNegative = numberInt < 0;
+
+        // Absolute value of lowest int does not fit in int, but fits in limb
+        const limb absolute = limb(std::int64_t(numberInt));
+        numberArr.push_back(isNegative ? ~absolute + 1 : absolute);
 
         this->purgeRadix();
     }
 
-    BigInt::BigInt(std::string s) {
+    BigInt::BigInt(std::string s, std::pmr::memory_resource *resource) :
+            numberArr(resource) {
         const size_t haveSign = (s[0] == '+' || s[0] == '-');
 #ifndef DEBUG
         try
@@ -60,27 +289,24 @@ namespace LongMath {
                 if (haveSign && s.size() == 1) {
                     throw std::invalid_argument("expected number, got only sign");
                 }
-                if (!std::isdigit(s[haveSign])) {
+                // All string is checked before conversion
+                const auto wrong = std::find_if(s.begin() + haveSign, s.end(),
+                                                [](unsigned char c) { return !std::isdigit(c); });
+                if (wrong != s.end()) {
                     throw std::invalid_argument("expected digit, got \"" +
-                                                std::string(1, s[haveSign]) +
+                                                std::string(1, *wrong) +
                                                 "\" in pos " +
-                                                std::to_string(haveSign) +
+                                                std::to_string(wrong - s.begin()) +
                                                 ", which is not a digit");
                 }
             }
-            numberArr.push_back(s[haveSign] - '0');
 
-            for (size_t i = haveSign + 1; i < s.size(); i++) {
-                if (!std::isdigit(s[i])) {
-                    throw std::invalid_argument("expected digit, got \"" +
-                                                std::string(1, s[i]) +
-                                                "\" in pos " +
-                                                std::to_string(i) +
-                                                ", which is not a digit");
-                }
-                (*this) *= DEC;
-                (*this) += BigInt(s[i] - '0');
-            }
+            // Lead zeros are skipped, they do not change number
+            const size_t first = std::min(s.find_first_not_of('0', haveSign), s.size());
+            LimbArray absolute(resource);
+            absolute.resize(kernels::radix_limbs(s.size() - first, 10) + 1);
+            absolute.resize(kernels::from_radix(absolute.data(), s.data() + first, s.size() - first, 10));
+            assignMagnitude(std::move(absolute), haveSign && s[0] == '-');
         }
 #ifndef DEBUG
         catch (const std::invalid_argument& e)
@@ -90,16 +316,45 @@ namespace LongMath {
             isNegative ^= isNegative;
         }
 #endif
+    }
 
-        if (haveSign && s[0] == '-') {
-            *this = -(*this);
+#ifdef DEBUG
+    BigInt::BigInt(const std::vector<uchar>& numberV) :
+            isNegative(numberV[numberV.size() - 1] > INT8_MAX) {
+        for (size_t i = 0; i < numberV.size(); i += sizeof(limb)) {
+            limb buf(0);
+            for (size_t j = 0; j < sizeof(limb); j++) {
+                const limb byte = i + j < numberV.size() ? numberV[i + j] : isNegative ? UINT8_MAX : 0;
+                buf |= byte << (j * UINT8_WIDTH);
+            }
+            numberArr.push_back(buf);
         }
 
+        // Bytes are in two's complement, but number keeps magnitude
+        if (isNegative) {
+            TwosComplement absolute(numberArr.data(), numberArr.size(), true);
+            for (limb &c: numberArr) {
+                c = absolute.next();
+            }
+        }
         purgeRadix();
     }
+#endif
+
+    BigInt::BigInt(const LimbView &view, std::pmr::memory_resource *resource) :
+            numberArr(resource) {
+        numberArr.resize(view.size);
+        std::copy(view.begin(), view.end(), numberArr.data());
+        fixMagnitude(view.negative);
+    }
 
     BigInt::BigInt(const BigInt &numberBI) :
-            isNegative(numberBI.isNegative) {
+            isNegative(numberBI.isNegative),
+            numberArr (numberBI.numberArr) {}
+
+    BigInt::BigInt(const BigInt &numberBI, std::pmr::memory_resource *resource) :
+            isNegative(numberBI.isNegative),
+            numberArr (resource) {
         numberArr = numberBI.numberArr;
     }
 
@@ -107,6 +362,13 @@ namespace LongMath {
             isNegative(numberBI.isNegative),
             numberArr (std::move(numberBI.numberArr)) {}
 
+    BigInt::BigInt(const BigInt &numberBI, size_t capacity) :
+            isNegative(numberBI.isNegative),
+            numberArr (numberBI.resource()) {
+        numberArr.reserve(capacity);
+        numberArr = numberBI.numberArr;
+    }
+
     // Destructor
     BigInt::~BigInt() = default;
 
@@ -117,23 +379,17 @@ namespace LongMath {
     // Assign operators
     BigInt &BigInt::operator=(const BigInt &numberBI) = default;
 
-    BigInt &BigInt::operator=(BigInt &&numberBI) noexcept {
+    BigInt &BigInt::operator=(BigInt &&numberBI) {
         isNegative = numberBI.isNegative;
         numberArr  = std::move(numberBI.numberArr);
         return *this;
     }
 
     // Invert bytes operator
+    // In two's complement ~x = -x - 1
     BigInt BigInt::operator~() const {
-        BigInt forRet;
-
-        for (uchar c: this->numberArr) {
-            forRet.numberArr.push_back(~c);
-        }
-
-        forRet.isNegative = !isNegative;
-
-        forRet.purgeRadix();
+        BigInt forRet(-(*this));
+        --forRet;
         return forRet;
     }
 
@@ -163,169 +419,92 @@ namespace LongMath {
 
     // Operators with "="
     BigInt &BigInt::operator+=(const BigInt &numberBI) {
-        for (size_t i = numberArr.size(); i < numberBI.numberArr.size(); i++) {
-            addRadix();
-        }
-        addRadix();
-
-        unsigned short carry = 0;
-        for (size_t i = 0; i < numberArr.size(); i++) {
-            carry += numberArr[i] + (i < numberBI.numberArr.size() ?
-                                     numberBI.numberArr[i] : numberBI.isNegative ?
-                                                             UINT8_MAX : 0);
-            numberArr[i] = uchar(carry & UINT8_MAX);
-            carry >>= UINT8_WIDTH;
-        }
-
-        if (((numberArr[numberArr.size() - 1] >> (UINT8_WIDTH - 1)) & 1) != isNegative) {
-            isNegative = !isNegative;
-        }
-
-        purgeRadix();
-
+        addSigned(numberBI.numberArr.data(), numberBI.numberArr.size(), numberBI.isNegative);
         return *this;
     }
 
     BigInt &BigInt::operator*=(const BigInt &numberBI) {
-        const BigInt a =          isNegative ? -(*this)  : *this;
-        const BigInt b = numberBI.isNegative ? -numberBI : numberBI;
-
-        BigInt answer(0);
-
-        for (size_t i = 1; i < b.numberArr.size(); i++) {
-            answer.numberArr.push_back(0);
-        }
-
-        for (size_t i = answer.numberArr.size(); i < a.size(); i++) {
-            answer.numberArr.push_back(0);
-        }
-
-        for (size_t i = 0; i < b.numberArr.size(); i++) {
-            unsigned long long carry = 0;
-            answer.numberArr.push_back(0);
-            for (size_t j = 0; j < a.numberArr.size(); j++) {
-                carry += answer.numberArr[i + j] + a.numberArr[j] * b.numberArr[i];
-                answer.numberArr[i + j] = (uchar) (carry & UINT8_MAX);
-                carry >>= 8;
-            }
-            answer.numberArr[i + numberArr.size()] += carry;
-        }
-
-        answer.purgeRadix();
-
-        isNegative ^= numberBI.isNegative;
-
-        if (isNegative) {
-            *this = -answer;
-        } else {
-            *this = answer;
-        }
-
+        mul(*this, *this, numberBI);
         return *this;
     }
 
     BigInt &BigInt::operator-=(const BigInt &numberBI) {
-        const BigInt inverted(-numberBI);
-        *this += inverted;
+        // Zero has no sign, so its magnitude may be added with any sign
+        addSigned(numberBI.numberArr.data(), numberBI.numberArr.size(), !numberBI.isNegative);
         return *this;
     }
 
     BigInt &BigInt::operator/=(const BigInt &numberBI) {
-        if (numberBI == ZERO) {
-            throw std::invalid_argument("division by zero");
-        }
-        const BigInt a(         isNegative ? -(*this)  : *this);
-        const BigInt b(numberBI.isNegative ? -numberBI : numberBI);
-
-        BigInt l(0);
-        BigInt r(a);
-        ++r;
-        BigInt m;
-        BigInt answer;
-
-        while (l < r) {
-            m = r + l;
-            m >>= 1;
-            if (m * b > a) {
-                r = m;
-            } else if (m * b < a - b + ONE) {
-                l = m + ONE;
-            } else {
-                answer = m;
-                break;
-            }
-        }
-        if (l == r) {
-            answer = l;
-        }
-
-        isNegative ^= numberBI.isNegative;
-
-        if (isNegative) {
-            *this = -answer;
-        } else {
-            *this = answer;
-        }
-
+        *this = divmod(*this, numberBI).first;
         return *this;
     }
 
     BigInt &BigInt::operator^=(const BigInt &numberBI) {
-        for (size_t i = numberArr.size(); i < numberBI.numberArr.size(); i++) {
-            addRadix();
-        }
-
-        for (size_t i = 0; i < numberArr.size(); i++) {
-            numberArr[i] ^= (i < numberBI.numberArr.size() ?
-                             numberBI.numberArr[i] : numberBI.isNegative ? UINT8_MAX : 0);
-        }
-
-        isNegative ^= numberBI.isNegative;
-
-        purgeRadix();
-
+        applyBitwise(numberBI, [](limb x, limb y) { return x ^ y; }, kernels::xor_n);
         return *this;
     }
 
     BigInt &BigInt::operator%=(const BigInt &numberBI) {
-        BigInt buf(*this);
-        buf /= numberBI;
-        buf *= numberBI;
-        *this -= buf;
+        *this = divmod(*this, numberBI).second;
         return *this;
     }
 
     BigInt &BigInt::operator&=(const BigInt &numberBI) {
-        for (size_t i = numberArr.size(); i < numberBI.numberArr.size(); i++) {
-            addRadix();
-        }
+        applyBitwise(numberBI, [](limb x, limb y) { return x & y; }, kernels::and_n);
+        return *this;
+    }
 
-        for (size_t i = 0; i < numberArr.size(); i++) {
-            numberArr[i] &= (i < numberBI.numberArr.size() ?
-                             numberBI.numberArr[i] : isNegative ? UINT8_MAX : 0);
-        }
+    BigInt &BigInt::operator|=(const BigInt &numberBI) {
+        applyBitwise(numberBI, [](limb x, limb y) { return x | y; }, kernels::ior_n);
+        return *this;
+    }
 
-        isNegative &= numberBI.isNegative;
+    // Shift of magnitude is same for both signs: -m << k = -(m << k)
+    BigInt &BigInt::operator<<=(size_t shift) {
+        const size_t n = normalizedSize(numberArr);
+        if (!n) {
+            return *this;
+        }
 
+        const size_t j(shift / LIMB_WIDTH);
+        const unsigned k(shift % LIMB_WIDTH);
+        numberArr.resize(n + j + 1);
+        limb *const r = numberArr.data();
+        if (k) {
+            r[n + j] = kernels::lshift(r + j, r, n, k);
+        } else {
+            r[n + j] = 0;
+            std::memmove(r + j, r, n * sizeof(limb));
+        }
+        std::fill(r, r + j, 0);
         purgeRadix();
-
         return *this;
     }
 
-    BigInt &BigInt::operator|=(const BigInt &numberBI) {
-        for (size_t i = numberArr.size(); i < numberBI.numberArr.size(); i++) {
-            addRadix();
+    BigInt &BigInt::operator>>=(size_t shift) {
+        // Shift of negative number is rounded down: -m >> k = -((m - 1) >> k) - 1
+        const limb one = 1;
+        if (isNegative) {
+            kernels::sub(numberArr.data(), numberArr.data(), numberArr.size(), &one, 1);
         }
 
-        for (size_t i = 0; i < numberArr.size(); i++) {
-            numberArr[i] |= (i < numberBI.numberArr.size() ?
-                             numberBI.numberArr[i] : isNegative ? UINT8_MAX : 0);
+        const size_t n = normalizedSize(numberArr);
+        const size_t j(std::min(shift / LIMB_WIDTH, n));
+        const unsigned k(shift % LIMB_WIDTH);
+        const size_t length = n - j;
+        limb *const r = numberArr.data();
+        if (k && length) {
+            kernels::rshift(r, r + j, length, k);
+        } else if (j) {
+            std::memmove(r, r + j, length * sizeof(limb));
         }
+        numberArr.resize(length);
 
-        isNegative |= numberBI.isNegative;
-
-        purgeRadix();
-
+        if (isNegative) {
+            addRadix();
+            kernels::add(numberArr.data(), numberArr.data(), numberArr.size(), &one, 1);
+        }
+        fixMagnitude(isNegative);
         return *this;
     }
 
@@ -336,7 +515,7 @@ namespace LongMath {
         const BigInt a(numberUC);
         BigInt forRet(*this);
         forRet %= a;
-        return forRet.numberArr[0];
+        return uchar(forRet.lowLimb());
     }
 
     // Unary sign operators
@@ -344,73 +523,42 @@ namespace LongMath {
         return *this;
     }
 
-    BigInt BigInt::operator-() const {
-        BigInt forRet(~(*this));
-        ++forRet;
+    BigInt BigInt::operator-() const & {
+        BigInt forRet(*this);
+        forRet.negate();
         return forRet;
     }
 
+    BigInt BigInt::operator-() && {
+        negate();
+        return std::move(*this);
+    }
+
     // Bool operators
     bool BigInt::operator==(const BigInt &numberBI) const {
-        if (!(isNegative ^ numberBI.isNegative) &&
-            numberArr == numberBI.numberArr) {
-            return true;
-        }
-        return false;
+        const size_t length = normalizedSize(numberArr);
+        return isNegative == numberBI.isNegative &&
+               length == normalizedSize(numberBI.numberArr) &&
+               !kernels::cmp(numberArr.data(), numberBI.numberArr.data(), length);
     }
 
     bool BigInt::operator!=(const BigInt &numberBI) const {
         return !((*this) == numberBI);
     }
 
+    // Comparison of magnitudes is reversed for negative numbers
     bool BigInt::operator<(const BigInt &numberBI) const {
         if (isNegative != numberBI.isNegative) {
-            if (isNegative) {
-                return true;
-            }
-            return false;
+            return isNegative;
         }
 
-        for (size_t j = (numberArr.size() > numberBI.numberArr.size() ?
-                         numberArr.size() : numberBI.numberArr.size()); j > 0; j--) {
-            const size_t i(j - 1);
-
-            if ((i < numberArr.size() ? numberArr[i] : isNegative ? UINT8_MAX : 0) >
-                (i < numberBI.numberArr.size() ? numberBI.numberArr[i] : numberBI.isNegative ? UINT8_MAX : 0)) {
-                return false;
-            }
-
-            if ((i < numberArr.size() ? numberArr[i] : isNegative ? UINT8_MAX : 0) <
-                (i < numberBI.numberArr.size() ? numberBI.numberArr[i] : numberBI.isNegative ? UINT8_MAX : 0)) {
-                return true;
-            }
-        }
-        return false;
+        const int c = compareMagnitudes(numberArr.data(), normalizedSize(numberArr),
+                                        numberBI.numberArr.data(), normalizedSize(numberBI.numberArr));
+        return isNegative ? c > 0 : c < 0;
     }
 
     bool BigInt::operator>(const BigInt &numberBI) const {
-        if (isNegative != numberBI.isNegative) {
-            if (isNegative) {
-                return false;
-            }
-            return true;
-        }
-
-        for (size_t j = (numberArr.size() > numberBI.numberArr.size() ?
-                         numberArr.size() : numberBI.numberArr.size()); j > 0; j--) {
-            const size_t i(j - 1);
-
-            if ((i < numberArr.size() ? numberArr[i] : isNegative ? UINT8_MAX : 0) <
-                (i < numberBI.numberArr.size() ? numberBI.numberArr[i] : numberBI.isNegative ? UINT8_MAX : 0)) {
-                return false;
-            }
-
-            if ((i < numberArr.size() ? numberArr[i] : isNegative ? UINT8_MAX : 0) >
-                (i < numberBI.numberArr.size() ? numberBI.numberArr[i] : numberBI.isNegative ? UINT8_MAX : 0)) {
-                return true;
-            }
-        }
-        return false;
+        return numberBI < *this;
     }
 
     bool BigInt::operator<=(const BigInt &numberBI) const {
@@ -423,104 +571,487 @@ namespace LongMath {
 
     // Different object's convertors
     BigInt::operator int() const {
-        int forRet(0);
-        for (size_t i = 0; i < sizeof(int); i++) {
-            forRet |= (i < numberArr.size() ?
-                       numberArr[i] : isNegative ? UINT8_MAX : 0) << (i * UINT8_WIDTH);
+        return int(std::uint32_t(lowLimb()));
+    }
+
+    BigInt::operator std::string() const {
+        return to_string(*this);
+    }
+
+    LimbView BigInt::limbs() const {
+        return {numberArr.data(), normalizedSize(numberArr), isNegative};
+    }
+
+    // Size of BigInt with sign
+    size_t BigInt::size() const {
+        return numberArr.size() * sizeof(limb) + sizeof(isNegative);
+    }
+
+    std::pmr::memory_resource *BigInt::resource() const {
+        return numberArr.resource();
+    }
+
+#ifdef DEBUG
+    std::vector<limb> BigInt::getArray() const {
+        std::vector<limb> forRet;
+        TwosComplement limbs(numberArr.data(), numberArr.size(), isNegative);
+        for (size_t i = 0; i < numberArr.size(); i++) {
+            forRet.push_back(limbs.next());
         }
         return forRet;
     }
 
-    BigInt::operator std::string() const {
-        std::string forRet;
-        std::vector<char> answer;
-        BigInt num(*this > ZERO ? *this : -(*this));
+    std::vector<uchar> BigInt::getBytes() const {
+        std::vector<uchar> forRet;
+        for (limb c: getArray()) {
+            for (size_t j = 0; j < sizeof(limb); j++) {
+                forRet.push_back(uchar(c >> (j * UINT8_WIDTH)));
+            }
+        }
+        while (forRet.size() > 1 && forRet.back() == (isNegative ? UINT8_MAX : 0)) {
+            forRet.pop_back();
+        }
+        return forRet;
+    }
+#endif
 
-        if (num == ZERO) {
-            forRet.push_back('0');
-            return forRet;
+    // Arithmetic with destination
+    namespace {
+        // Buffers for magnitudes in functions below, they keep their memory between calls
+        LimbArray &scratch(size_t i) {
+            thread_local LimbArray buffers[3];
+            return buffers[i];
         }
+    }
 
-        while (num > ZERO) {
-            answer.push_back(char((num % uchar(DECIMAL_SYSTEM_BASE)) + '0'));
-            num /= DEC;
+    void add(BigInt &dst, const BigInt &a, const BigInt &b) {
+        if (&dst == &b) {
+            dst += a;
+            return;
         }
+        dst = a;
+        dst += b;
+    }
 
-        if (*this < ZERO) {
-            answer.push_back('-');
+    void sub(BigInt &dst, const BigInt &a, const BigInt &b) {
+        if (&dst == &b) {
+            // a - b = -(b - a)
+            dst -= a;
+            dst.negate();
+            return;
         }
+        dst = a;
+        dst -= b;
+    }
+
+    void mul(BigInt &dst, const BigInt &a, const BigInt &b, size_t threads) {
+        const size_t aLength = normalizedSize(a.numberArr);
+        const size_t bLength = normalizedSize(b.numberArr);
+        const bool negative  = a.isNegative != b.isNegative;
 
-        for (size_t i = answer.size(); i > 0; i--) {
-            forRet.push_back(answer[i - 1]);
+        // Product is written to dst straight, if it is not an argument
+        const bool aliased = &dst == &a || &dst == &b;
+        LimbArray &answer = aliased ? scratch(0) : dst.numberArr;
+        answer.resize(aLength + bLength);
+        kernels::mul(answer.data(), a.numberArr.data(), aLength, b.numberArr.data(), bLength, threads);
+
+        if (aliased) {
+            dst.numberArr = answer;
         }
+        dst.fixMagnitude(negative);
+    }
 
-        return forRet;
+    void addmul(BigInt &dst, const BigInt &a, const BigInt &b) {
+        const size_t aLength = normalizedSize(a.numberArr);
+        const size_t bLength = normalizedSize(b.numberArr);
+
+        LimbArray &product = scratch(0);
+        product.resize(aLength + bLength);
+        kernels::mul(product.data(), a.numberArr.data(), aLength, b.numberArr.data(), bLength);
+        dst.addSigned(product.data(), product.size(), a.isNegative != b.isNegative);
     }
 
-    // Size of BigInt with sign
-    size_t BigInt::size() const {
-        return numberArr.size() + sizeof(isNegative);
+    void divmod(BigInt &q, BigInt &r, const BigInt &a, const BigInt &b) {
+        if (b == ZERO) {
+            throw std::invalid_argument("division by zero");
+        }
+        // q and r may be same as a or b, so magnitudes are copied in that case
+        const bool aliased = &q == &a || &q == &b || &r == &a || &r == &b;
+        const LimbArray &u = aliased ? scratch(0) = a.numberArr : a.numberArr;
+        const LimbArray &v = aliased ? scratch(1) = b.numberArr : b.numberArr;
+        const size_t uLength = normalizedSize(u);
+        const size_t vLength = normalizedSize(v);
+        const bool rNegative = a.isNegative;
+        const bool qNegative = a.isNegative != b.isNegative;
+
+        if (compareMagnitudes(u.data(), uLength, v.data(), vLength) < 0) {
+            r.numberArr = u;
+            r.fixMagnitude(rNegative);
+            q.numberArr.resize(0);
+            q.fixMagnitude(false);
+            return;
+        }
+
+        q.numberArr.resize(uLength - vLength + 1);
+        r.numberArr.resize(vLength);
+        kernels::divrem(q.numberArr.data(), r.numberArr.data(), u.data(), uLength, v.data(), vLength);
+        q.fixMagnitude(qNegative);
+        r.fixMagnitude(rNegative);
+    }
+
+    std::pair<BigInt, BigInt> divmod(const BigInt &a, const BigInt &b) {
+        std::pair<BigInt, BigInt> forRet(BigInt(a.resource()), BigInt(a.resource()));
+        divmod(forRet.first, forRet.second, a, b);
+        return forRet;
     }
 
     // Binary operators
+    // Copy of left operand gets memory for one more radix, so compound operator does not allocate again
     BigInt operator+(const BigInt &a, const BigInt &b) {
-        BigInt forRet(a);
+        BigInt forRet(a, std::max(a.numberArr.size(), b.numberArr.size()) + 1);
         forRet += b;
         return forRet;
     }
 
     BigInt operator-(const BigInt &a, const BigInt &b) {
-        BigInt forRet(a);
+        BigInt forRet(a, std::max(a.numberArr.size(), b.numberArr.size()) + 1);
         forRet -= b;
         return forRet;
     }
 
     BigInt operator*(const BigInt &a, const BigInt &b) {
-        BigInt forRet(a);
-        forRet *= b;
+        BigInt forRet(a.resource());
+        mul(forRet, a, b);
         return forRet;
     }
 
     BigInt operator/(const BigInt &a, const BigInt &b) {
-        BigInt forRet(a);
-        forRet /= b;
-        return forRet;
+        return divmod(a, b).first;
     }
 
     BigInt operator^(const BigInt &a, const BigInt &b) {
-        BigInt forRet(a);
+        BigInt forRet(a, std::max(a.numberArr.size(), b.numberArr.size()) + 1);
         forRet ^= b;
         return forRet;
     }
 
     BigInt operator%(const BigInt &a, const BigInt &b) {
-        BigInt forRet(a);
-        forRet %= b;
-        return forRet;
+        return divmod(a, b).second;
     }
 
     BigInt operator&(const BigInt &a, const BigInt &b) {
-        BigInt forRet(a);
+        BigInt forRet(a, std::max(a.numberArr.size(), b.numberArr.size()) + 1);
         forRet &= b;
         return forRet;
     }
 
     BigInt operator|(const BigInt &a, const BigInt &b) {
-        BigInt forRet(a);
+        BigInt forRet(a, std::max(a.numberArr.size(), b.numberArr.size()) + 1);
         forRet |= b;
         return forRet;
     }
 
+    // Binary operators for temporary operands, which give their memory to result
+    BigInt operator+(BigInt &&a, const BigInt &b) {
+        a += b;
+        return std::move(a);
+    }
+
+    BigInt operator+(const BigInt &a, BigInt &&b) {
+        b += a;
+        return std::move(b);
+    }
+
+    BigInt operator+(BigInt &&a, BigInt &&b) {
+        a += b;
+        return std::move(a);
+    }
+
+    BigInt operator-(BigInt &&a, const BigInt &b) {
+        a -= b;
+        return std::move(a);
+    }
+
+    // a - b = -(b - a)
+    BigInt operator-(const BigInt &a, BigInt &&b) {
+        b -= a;
+        return -std::move(b);
+    }
+
+    BigInt operator-(BigInt &&a, BigInt &&b) {
+        a -= b;
+        return std::move(a);
+    }
+
+    BigInt operator^(BigInt &&a, const BigInt &b) {
+        a ^= b;
+        return std::move(a);
+    }
+
+    BigInt operator^(const BigInt &a, BigInt &&b) {
+        b ^= a;
+        return std::move(b);
+    }
+
+    BigInt operator^(BigInt &&a, BigInt &&b) {
+        a ^= b;
+        return std::move(a);
+    }
+
+    BigInt operator&(BigInt &&a, const BigInt &b) {
+        a &= b;
+        return std::move(a);
+    }
+
+    BigInt operator&(const BigInt &a, BigInt &&b) {
+        b &= a;
+        return std::move(b);
+    }
+
+    BigInt operator&(BigInt &&a, BigInt &&b) {
+        a &= b;
+        return std::move(a);
+    }
+
+    BigInt operator|(BigInt &&a, const BigInt &b) {
+        a |= b;
+        return std::move(a);
+    }
+
+    BigInt operator|(const BigInt &a, BigInt &&b) {
+        b |= a;
+        return std::move(b);
+    }
+
+    BigInt operator|(BigInt &&a, BigInt &&b) {
+        a |= b;
+        return std::move(a);
+    }
+
+    // Shift operators
+    BigInt operator<<(const BigInt &a, size_t shift) {
+        BigInt forRet(a, a.numberArr.size() + shift / LIMB_WIDTH + 1);
+        forRet <<= shift;
+        return forRet;
+    }
+
+    BigInt operator<<(BigInt &&a, size_t shift) {
+        a <<= shift;
+        return std::move(a);
+    }
+
+    BigInt operator>>(const BigInt &a, size_t shift) {
+        BigInt forRet(a);
+        forRet >>= shift;
+        return forRet;
+    }
+
+    BigInt operator>>(BigInt &&a, size_t shift) {
+        a >>= shift;
+        return std::move(a);
+    }
 
     // Stream operators
     std::ostream &operator<<(std::ostream &out, const BigInt &numberBI) {
-        return out << std::string(numberBI);
+        return out << to_string(numberBI, streamBase(out));
     }
 
     std::istream &operator>>(std::istream &in, BigInt &numberBI) {
-        std::string s;
-        in >> s;
-        numberBI = BigInt(s);
+        // Sentry skips white spaces (if std::skipws is set)
+        const std::istream::sentry sentry(in);
+        if (!sentry) {
+            return in;
+        }
+
+        // Characters are taken right from buffer of streambuf, character after number stays in it
+        std::streambuf *const buffer = in.rdbuf();
+        const ScannedNumber number = scanNumber(buffer->sgetc(), [buffer] { return buffer->snextc(); },
+                                                streamBase(in));
+        if (number.stop == EOF) {
+            in.setstate(std::ios_base::eofbit);
+        }
+        if (!number.haveDigits) {
+            in.setstate(std::ios_base::failbit);
+            return in;
+        }
+
+        LimbArray magnitude(numberBI.resource());
+        magnitude.resize(number.magnitude.size());
+        std::copy(number.magnitude.begin(), number.magnitude.end(), magnitude.data());
+        numberBI.assignMagnitude(std::move(magnitude), number.negative);
         return in;
     }
+
+    bool read_number(std::FILE *file, BigInt &numberBI, unsigned base) {
+        if (base < 2 || base > 36) {
+            throw std::invalid_argument("base must be from 2 to 36");
+        }
+        // Lock is taken once, then characters are taken from stdio buffer, which is filled by big reads of file
+        const FileLock lock(file);
+        int c = getc_unlocked(file);
+        while (c != EOF && std::isspace(c)) {
+            c = getc_unlocked(file);
+        }
+        const ScannedNumber number = scanNumber(c, [file] { return getc_unlocked(file); }, base);
+        if (number.stop != EOF) {
+            ungetc(number.stop, file);
+        }
+        if (!number.haveDigits) {
+            return false;
+        }
+
+        LimbArray magnitude(numberBI.resource());
+        magnitude.resize(number.magnitude.size());
+        std::copy(number.magnitude.begin(), number.magnitude.end(), magnitude.data());
+        numberBI.assignMagnitude(std::move(magnitude), number.negative);
+        return true;
+    }
+
+    // Conversions with any base
+    std::string to_string(const BigInt &numberBI, unsigned base, bool prefix) {
+        if (base < 2 || base > 36) {
+            throw std::invalid_argument("base must be from 2 to 36");
+        }
+        std::string head(numberBI.isNegative ? "-" : "");
+        if (prefix) {
+            head += base == 16 ? "0x" : base == 8 ? "0o" : base == 2 ? "0b" : "";
+        }
+
+        const size_t length = normalizedSize(numberBI.numberArr);
+        const size_t width  = kernels::radix_size(numberBI.numberArr.data(), length, base);
+        std::string forRet(head.size() + width, '0');
+        std::copy(head.begin(), head.end(), forRet.begin());
+        kernels::to_radix(&forRet[head.size()], width, numberBI.numberArr.data(), length, base);
+
+        // Estimation of digits number may give lead zeros, but zero itself keeps its digit
+        const size_t lead = std::min(forRet.find_first_not_of('0', head.size()), forRet.size() - 1);
+        forRet.erase(head.size(), lead - head.size());
+        return forRet;
+    }
+
+    BigInt from_string(const std::string &s, unsigned base, std::pmr::memory_resource *resource) {
+        if (base == 1 || base > 36) {
+            throw std::invalid_argument("base must be 0 or from 2 to 36");
+        }
+        const bool haveSign = !s.empty() && (s[0] == '+' || s[0] == '-');
+        size_t first = haveSign;
+
+        // Prefix is taken only if it is prefix of given base, so "0b1" with base 16 is number 0xb1
+        if (s.size() >= first + 2 && s[first] == '0') {
+            const char letter = char(s[first + 1] | 0x20);
+            const unsigned prefixBase = letter == 'x' ? 16 : letter == 'o' ? 8 : letter == 'b' ? 2 : 0;
+            if (prefixBase && (!base || base == prefixBase)) {
+                base   = prefixBase;
+                first += 2;
+            }
+        }
+        if (!base) {
+            base = 10;
+        }
+
+        if (first == s.size()) {
+            throw std::invalid_argument("expected number, got \"" + s + "\"");
+        }
+        const auto wrong = std::find_if(s.begin() + first, s.end(), [base](unsigned char c) {
+            return digitValue(c) >= base;
+        });
+        if (wrong != s.end()) {
+            throw std::invalid_argument("expected digit, got \"" +
+                                        std::string(1, *wrong) +
+                                        "\" in pos " +
+                                        std::to_string(wrong - s.begin()) +
+                                        ", which is not a digit of base " +
+                                        std::to_string(base));
+        }
+
+        // Lead zeros are skipped, they do not change number
+        first = std::min(s.find_first_not_of('0', first), s.size());
+        BigInt forRet(resource);
+        LimbArray absolute(resource);
+        absolute.resize(kernels::radix_limbs(s.size() - first, base) + 1);
+        absolute.resize(kernels::from_radix(absolute.data(), s.data() + first, s.size() - first, base));
+        forRet.assignMagnitude(std::move(absolute), haveSign && s[0] == '-');
+        return forRet;
+    }
+
+    // Binary import and export
+    size_t export_size(const BigInt &numberBI, bool isSigned) {
+        const limb *const m = numberBI.numberArr.data();
+        const size_t n = normalizedSize(numberBI.numberArr);
+        size_t bits = n ? n * LIMB_WIDTH - __builtin_clzll(m[n - 1]) : 0;
+        if (isSigned) {
+            // Sign takes one more bit, except -2^k, which is one bit and zeros after it in two's complement
+            const bool powerOfTwo = n && !(m[n - 1] & (m[n - 1] - 1)) && !kernels::normalizedSize(m, n - 1);
+            if (!numberBI.isNegative || !powerOfTwo) {
+                bits++;
+            }
+        }
+        return (bits + 7) / 8;
+    }
+
+    void export_bytes(uchar *dst, size_t size, const BigInt &numberBI, ByteOrder order, bool isSigned) {
+        if (size < export_size(numberBI, isSigned)) {
+            throw std::invalid_argument("buffer is too small for number");
+        }
+        const LimbView view = numberBI.limbs();
+        const size_t bytes = std::min(size, view.size * sizeof(limb));
+
+        // Bytes are written in little-endian order first
+        if (isSigned && view.negative) {
+            TwosComplement limbs(view.data, view.size, true);
+            for (size_t i = 0; i < bytes; i += sizeof(limb)) {
+                storeBytes(dst + i, limbs.next(), std::min(sizeof(limb), bytes - i));
+            }
+            std::fill(dst + bytes, dst + size, 0xff);
+        } else {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            std::memcpy(dst, view.data, bytes);
+#else
+            for (size_t i = 0; i < bytes; i += sizeof(limb)) {
+                storeBytes(dst + i, view[i / sizeof(limb)], std::min(sizeof(limb), bytes - i));
+            }
+#endif
+            std::fill(dst + bytes, dst + size, 0);
+        }
+        if (order == ByteOrder::big) {
+            std::reverse(dst, dst + size);
+        }
+    }
+
+    BigInt import_bytes(const uchar *src, size_t size, ByteOrder order, bool isSigned,
+                        std::pmr::memory_resource *resource) {
+        LimbArray magnitude(resource);
+        magnitude.resize((size + sizeof(limb) - 1) / sizeof(limb));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uchar *const bytes = reinterpret_cast<uchar *>(magnitude.data());
+        if (order == ByteOrder::little) {
+            std::memcpy(bytes, src, size);
+        } else {
+            std::reverse_copy(src, src + size, bytes);
+        }
+#else
+        for (size_t i = 0; i < size; i++) {
+            const uchar byte = order == ByteOrder::little ? src[i] : src[size - 1 - i];
+            magnitude[i / sizeof(limb)] |= limb(byte) << (8 * (i % sizeof(limb)));
+        }
+#endif
+
+        const uchar high = !size ? 0 : order == ByteOrder::little ? src[size - 1] : src[0];
+        const bool negative = isSigned && (high & 0x80);
+        if (negative) {
+            // Sign is extended to whole last limb, then magnitude is ~x + 1
+            for (size_t i = size; i < magnitude.size() * sizeof(limb); i++) {
+                magnitude.back() |= limb(0xff) << (8 * (i % sizeof(limb)));
+            }
+            limb carry = 1;
+            for (limb &x: magnitude) {
+                x = ~x + carry;
+                carry = carry && !x;
+            }
+        }
+
+        BigInt forRet(resource);
+        forRet.assignMagnitude(std::move(magnitude), negative);
+        return forRet;
+    }
 }
@@ -1,3 +1,17 @@
+#pragma once
+
+#ifndef array
+#include <array>
+#endif
+
+#ifndef cstdint
+#include <cstdint>
+#endif
+
+#ifndef cstdio
+#include <cstdio>
+#endif
+
 #ifndef iostream
 #include <iostream>
 #endif
@@ -6,23 +20,54 @@
 #include <limits>
 #endif
 
+#ifndef stdexcept
+#include <stdexcept>
+#endif
+
 #ifndef string
 #include <string>
 #endif
 
+#ifndef utility
+#include <utility>
+#endif
+
 #ifndef vector
 #include <vector>
 #endif
 
+#include "LimbArray.h"
+
 #define DEBUG
 
 // BigInt is a part of namespace LongMath
 namespace LongMath
 {
-    // In this realisation the basic type of BigInt is unsigned char,
-    // which is easier to typedef for shorter name
+    // Limb types are declared in LimbArray.h
     typedef unsigned char uchar;
 
+    // Non-owning view of limbs of magnitude (lower limb goes first, no lead zero limbs, so zero has no limbs)
+    // It stays valid while number is not changed or destroyed
+    struct LimbView {
+        const limb *data;
+        size_t      size;
+        bool        negative;
+
+        [[nodiscard]] const limb *begin() const { return data; }
+        [[nodiscard]] const limb *end()   const { return data + size; }
+        const limb &operator[](size_t i) const { return data[i]; }
+    };
+
+    namespace kernels {
+        struct Complements;
+    }
+
+    // Order of bytes for import and export
+    enum class ByteOrder {
+        little,
+        big
+    };
+
     class BigInt {
     public:
         // Constructors
@@ -30,24 +75,31 @@ namespace LongMath
         // Default constructor makes uninitialized positive number with no meaning numbers
         // Not recommended for manipulate with
         BigInt();
+        // Makes zero, which takes memory for limbs from resource (see resource below)
+        explicit BigInt(std::pmr::memory_resource *resource);
         // Converts signed int number to BigInt by copying all numbers in binary from int to BigInt
         // Sign is setting by lead bit
-        explicit BigInt(int);
+        explicit BigInt(int, std::pmr::memory_resource *resource = std::pmr::get_default_resource());
         // Converts std::string, which consists number with sign in decimal based system
-        // to BigInt using Horner's method
+        // to BigInt: string is checked first, then digits are read by chunks of 19 to one limb,
+        // long strings are split in halves, which are joined by multiplication by cached power of 10
+        // (see RADIX_CONVERSION_THRESHOLD)
         // Throws std::invalid argument when got not a number in decimal based system
-        explicit BigInt(std::string s);
-        // Default copy constructor
+        explicit BigInt(std::string s, std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+        // Copies magnitude from view (it may have lead zero limbs) and takes its sign
+        explicit BigInt(const LimbView&, std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+        // Default copy constructor, copy takes memory from same resource
         BigInt(const BigInt&);
+        // Copies number to memory from given resource
+        BigInt(const BigInt&, std::pmr::memory_resource *resource);
         // Default move constructor
         BigInt(BigInt&&) noexcept;
 
         // Marker DEBUG is used for GTests
         // std::vector<uchar> constructor helps to set number by digits easily
+        // Bytes are packed to limbs, sign is taken from lead byte
 #ifdef DEBUG
-        explicit BigInt(std::vector<uchar> numberV) :
-            isNegative(numberV[numberV.size() - 1] > INT8_MAX),
-            numberArr (numberV) {}
+        explicit BigInt(const std::vector<uchar>& numberV);
 #endif
 
         // Default destructor
@@ -59,8 +111,8 @@ namespace LongMath
 
         // Default copy assignment
         BigInt &operator=(const BigInt &);
-        // Default move assignment
-        BigInt &operator=(      BigInt &&) noexcept;
+        // Move assignment takes memory of argument if it is from equal resource, otherwise copies it
+        BigInt &operator=(      BigInt &&);
 
         // Inverts bits and sign in number
         BigInt operator~() const;
@@ -75,53 +127,49 @@ namespace LongMath
         const BigInt  operator++(int);
         const BigInt  operator--(int);
 
-        // Operator+= aligns left number to right's number size if necessary
-        // and then adds another radix to avoid unexpected sign changing or overflowing
-        // Then makes default strikingly addition with writing result in left number
+        // Operator+= adds magnitudes if signs are same, otherwise subtracts less magnitude from greater one
+        // Result is written in left number, which gets one more radix only for carry
         BigInt &operator+=(const BigInt &);
 
-        // Operator*= makes copy of arguments with absolute value (both copies are positive)
-        // Then makes special BigInt answer, which is aligned to max size of arguments
-        // Then makes default strikingly multiplication with adding radix to answer on every step
-        // to avoid overflowing and unexpected sign changing
+        // Operator*= calls mul (see below), which multiplies absolute values without copying
+        // with default strikingly multiplication, Karatsuba, Toom-3 or number theoretic transform
+        // depending on length (see KARATSUBA_THRESHOLD, TOOM3_THRESHOLD and NTT_THRESHOLD)
         // After multiplication is done it changes sign of answer if necessary and write it to left argument
         BigInt &operator*=(const BigInt &);
 
-        // This operator makes copy of right argument with changing its sign
-        // and then calls operator+=, but with inverted copy of argument
+        // Operator-= works same as operator+= with opposite sign of right argument,
+        // so right argument is not copied
         BigInt &operator-=(const BigInt &);
 
-        // Operator/= makes copy of arguments with absolute value (both copies are positive)
-        // And then it uses binary search on BigInt for quick division
-        // It uses fact that the result of division multiplied with divider can be in
-        // interval (divisible - divider, divider]
-        // And using this fact we move right and left border
-        // After division is done it changes sign of answer if necessary and write it to left argument
+        // Operator/= takes quotient from divmod (see below) and writes it to left argument
         // Division by zero calls std::invalid_argument
         BigInt &operator/=(const BigInt &);
 
-        // This 3 operators do same:
-        // Align left number to right number
+        // This 3 operators work as with two's complement numbers:
+        // Negative arguments are turned to two's complement limb by limb on the fly
         // Do bitwise operation
-        // Modify sign
+        // Negative result is turned back to magnitude
         BigInt &operator^=(const BigInt &);
         BigInt &operator&=(const BigInt &);
         BigInt &operator|=(const BigInt &);
 
-        // Operator%= consist of making copy of left argument
-        // Then this copy divides by right argument (/=)
-        // Then it multiplies by right argument     (*=)
-        // The result will be difference between original number and modified
+        // Bit shifts work as with two's complement numbers:
+        // operator<<= multiplies by 2^shift, operator>>= divides by 2^shift rounding down,
+        // so negative number never becomes zero (-1 >> shift = -1)
+        // Whole limbs are moved by memmove, rest of shift is done by funnel shift of neighbour limbs
+        BigInt &operator<<=(size_t);
+        BigInt &operator>>=(size_t);
+
+        // Operator%= takes remainder from divmod (see below) and writes it to left argument
         BigInt &operator%=(const BigInt &);
 
         // Unary operator+ returns *this (does nothing with number)
         BigInt operator+() const;
 
-        // Unary operator- makes copy of number with inverted bits (~)
-        // and then adds 1 to copy
-        // returns copy
-        // Same method is used in default signed types in C++
-        BigInt operator-() const; //unary
+        // Unary operator- makes copy of number and changes its sign
+        // Temporary number is negated without copying
+        BigInt operator-() const &; //unary
+        BigInt operator-() &&;
 
         // Default equal operator
         // Uses built in methods for comparing
@@ -132,7 +180,8 @@ namespace LongMath
 
         // These 2 operators first check sign of arguments
         // If signs are different obviously
-        // If signs are same they compare numbers from last radix to first
+        // If signs are same they compare magnitudes from last radix to first,
+        // greater magnitude of negative number means less number
         bool operator< (const BigInt &) const;
         bool operator> (const BigInt &) const;
 
@@ -140,28 +189,38 @@ namespace LongMath
         bool operator<=(const BigInt &) const;
         bool operator>=(const BigInt &) const;
 
-        // Turns first 4 bytes to int number
+        // Turns low 4 bytes of number in two's complement to int number
         explicit operator int() const;
 
-        // Pushes back (remainder of division by 10 + '0') in std::vector<char>
-        // Divide number by 10
-        // Does it while number > 0
-        // if number < 0 puts '-' to std::string
-        // Then reverse std::vector and put it elements to std::string
+        // Writes decimal digits of absolute value straight to std::string with enough length,
+        // then erases lead zeros, puts '-' first if number < 0 (same as to_string below with base 10)
+        // Digits are taken by 19 from remainders of division by 10^19, big numbers
+        // are split in halves by division by cached powers of 10 (see RADIX_CONVERSION_THRESHOLD)
         explicit operator std::string() const;
 
-        // This method is used for GTest
-        // Returns number in 256-based system
+        // These methods are used for GTest
+        // getArray returns number in two's complement in 2^64-based system
+        // getBytes returns number in two's complement in 256-based system, without lead bytes,
+        // which are same as sign extension (but at least one byte stays)
 #ifdef DEBUG
-        const std::vector<uchar>& getArray()
-        {
-            return numberArr;
-        }
+        [[nodiscard]] std::vector<limb> getArray() const;
+
+        [[nodiscard]] std::vector<uchar> getBytes() const;
 #endif
 
+        // Returns view of limbs of magnitude without copying (see LimbView)
+        [[nodiscard]] LimbView limbs() const;
+
         // Returns size in bytes
         [[nodiscard]] size_t size() const;
 
+        // Returns resource, which gives memory for limbs
+        // Numbers with more than LimbArray::INLINE_CAPACITY limbs take memory from it,
+        // results of operators take memory from resource of left operand
+        // So many short-lived numbers can be made in std::pmr::monotonic_buffer_resource
+        // and freed together with it (numbers must be destroyed before resource)
+        [[nodiscard]] std::pmr::memory_resource *resource() const;
+
         // Is used for GTest
 #ifdef DEBUG
         [[nodiscard]] bool lessZero() const
@@ -176,16 +235,58 @@ namespace LongMath
 
     private:
         bool isNegative = false;        // Sign = { 0 if number >= 0; 1 if < 0}
-        std::vector <uchar> numberArr;  // Array of 1-byte elements,
-                                        // every i element means i+1 radix in 256-based system
+        LimbArray numberArr;            // Absolute value in array of 8-byte limbs, two of them are kept inside object,
+                                        // every i element means i+1 radix in 2^64-based system
+                                        // Lead radix is not zero (except zero number itself)
+
+        // Changes sign of number in place, zero stays non-negative
+        void negate();
+        // Sets number to magnitude with given sign, magnitude may have lead zero limbs
+        void assignMagnitude(LimbArray &&magnitudeV, bool negative);
+        // Same, but magnitude is already written to numberArr
+        void fixMagnitude(bool negative);
+        // Adds number with magnitude m with length n and given sign
+        void addSigned(const limb *m, size_t n, bool negative);
+        // Does bitwise operation op with number as in two's complement, kernel does op on common limbs
+        void applyBitwise(const BigInt &numberBI, limb (*op)(limb, limb),
+                          void (*kernel)(limb*, const limb*, const limb*, size_t, kernels::Complements));
+        // Returns low limb of number in two's complement
+        [[nodiscard]] limb lowLimb() const;
+
+        // Copy constructor, which reserves memory for capacity limbs
+        BigInt(const BigInt &numberBI, size_t capacity);
+
+        friend void sub(BigInt&, const BigInt&, const BigInt&);
+        friend void mul(BigInt&, const BigInt&, const BigInt&, size_t);
+        friend void addmul(BigInt&, const BigInt&, const BigInt&);
+        friend void divmod(BigInt&, BigInt&, const BigInt&, const BigInt&);
+        friend BigInt operator+(const BigInt&, const BigInt&);
+        friend BigInt operator-(const BigInt&, const BigInt&);
+        friend BigInt operator^(const BigInt&, const BigInt&);
+        friend BigInt operator&(const BigInt&, const BigInt&);
+        friend BigInt operator|(const BigInt&, const BigInt&);
+        friend BigInt operator<<(const BigInt&, size_t);
+        friend BigInt powmod(const BigInt&, const BigInt&, const BigInt&);
+        friend class Montgomery;
+        friend class Reducer;
+        friend class Euclid;
+        friend class ProductTree;
+        template <size_t, bool> friend class FixedInt;
+        friend std::istream& operator>>(std::istream&, BigInt&);
+        friend bool read_number(std::FILE*, BigInt&, unsigned);
+        friend std::string to_string(const BigInt&, unsigned, bool);
+        friend BigInt from_string(const std::string&, unsigned, std::pmr::memory_resource*);
+        friend size_t export_size(const BigInt&, bool);
+        friend void export_bytes(uchar*, size_t, const BigInt&, ByteOrder, bool);
+        friend BigInt import_bytes(const uchar*, size_t, ByteOrder, bool, std::pmr::memory_resource*);
+        friend BigInt isqrt(const BigInt&);
+        friend BigInt iroot(const BigInt&, size_t);
+        friend bool is_perfect_square(const BigInt&);
 
 #ifdef DEBUG
     public:
 #endif
-        // Byte shift, used in operator "/=" for quick division by 2
-        BigInt &operator>>=(size_t);
-
-        // Functions for manipulating void radixes
+        // Functions for manipulating void (zero) radixes
         void addRadix  ();
         void purgeRadix();
     };
@@ -197,10 +298,71 @@ namespace LongMath
 
     const size_t DECIMAL_SYSTEM_BASE = 10;
 
+    // Multiplication uses Karatsuba when both arguments have at least
+    // KARATSUBA_THRESHOLD limbs, Toom-3 from TOOM3_THRESHOLD limbs
+    // and number theoretic transform from NTT_THRESHOLD limbs
+    // Squaring takes about half of products of multiplication, so it uses Karatsuba
+    // from KARATSUBA_SQR_THRESHOLD limbs (and other thresholds as multiplication)
+    // Can be changed to tune multiplication for the machine
+    inline size_t KARATSUBA_THRESHOLD     = 32;
+    inline size_t KARATSUBA_SQR_THRESHOLD = 96;
+    inline size_t TOOM3_THRESHOLD         = 256;
+    inline size_t NTT_THRESHOLD           = 3072;
+
+    // Multiplication, where shorter operand has at least PARALLEL_MUL_THRESHOLD limbs, runs its parts
+    // (products of Karatsuba and Toom-3, pieces of unbalanced operands, transforms of NTT)
+    // in MUL_THREADS threads of one pool, 1 turns it off
+    // Every part is computed exactly, so product does not depend on number of threads
+    inline size_t MUL_THREADS            = 1;
+    inline size_t PARALLEL_MUL_THRESHOLD = 1024;
+
+    // Linear kernels (comparison, addition, subtraction, bitwise operations and multiplication by one limb)
+    // use AVX2, AVX-512, ADC chains or MULX and ADX when processor has them, false makes them use portable loops
+    // Every higher multiplication and division is built on them
+    inline bool SIMD_KERNELS = true;
+
+    // Division uses Barrett's reduction with Newton's reciprocal instead of
+    // Knuth's algorithm D when divisor and quotient have at least BARRETT_THRESHOLD limbs
+    inline size_t BARRETT_THRESHOLD   = 64;
+
+    // Conversion to decimal (or other base, which is not power of 2) system divides numbers
+    // with at least RADIX_CONVERSION_THRESHOLD limbs by big powers of base and converts parts recursively,
+    // parsing of strings with at least RADIX_CONVERSION_THRESHOLD limbs of digits joins parts in same way
+    inline size_t RADIX_CONVERSION_THRESHOLD = 32;
+
+    // Gcd of numbers with at least GCD_DC_THRESHOLD limbs uses half gcd: matrix for high half of numbers
+    // is found recursively and applied to whole numbers by fast multiplication (see Gcd.cpp)
+    // Recursion of half gcd stops at HGCD_THRESHOLD limbs, where Lehmer's steps are used
+    inline size_t HGCD_THRESHOLD   = 128;
+    inline size_t GCD_DC_THRESHOLD = 1024;
+
+    // Divides first argument by second on absolute values with Knuth's algorithm D
+    // or Barrett's reduction (see BARRETT_THRESHOLD)
+    // Returns quotient and remainder together: quotient is rounded to zero,
+    // remainder has sign of divisible (same as for built in types)
+    // Division by zero calls std::invalid_argument
+    std::pair<BigInt, BigInt> divmod(const BigInt&, const BigInt&);
+
+    // Arithmetic with destination: result is written to first argument using its memory,
+    // so calls with warmed up destination do not allocate (except temporary arrays
+    // of Karatsuba and faster algorithms for long numbers)
+    // Destination may be same as any argument
+    // dst = a + b
+    void add(BigInt &dst, const BigInt &a, const BigInt &b);
+    // dst = a - b
+    void sub(BigInt &dst, const BigInt &a, const BigInt &b);
+    // dst = a * b, long product is found in threads threads (see MUL_THREADS)
+    void mul(BigInt &dst, const BigInt &a, const BigInt &b, size_t threads = MUL_THREADS);
+    // dst += a * b
+    void addmul(BigInt &dst, const BigInt &a, const BigInt &b);
+    // q = a / b, r = a % b as in divmod above, q and r must be different numbers
+    void divmod(BigInt &q, BigInt &r, const BigInt &a, const BigInt &b);
+
     // These binary operators works same:
-    // Make copy of left operand
+    // Make copy of left operand with memory for result
     // call operator+= for copy and right operand
     // returns copy
+    // Operator* writes product straight to result, operator/ and operator% take it from divmod
     BigInt operator+(const BigInt&, const BigInt&);
     BigInt operator-(const BigInt&, const BigInt&);
     BigInt operator*(const BigInt&, const BigInt&);
@@ -210,9 +372,135 @@ namespace LongMath
     BigInt operator&(const BigInt&, const BigInt&);
     BigInt operator|(const BigInt&, const BigInt&);
 
-    // Ostream operator<< calls std::string(BigInt) and puts std::string to ostream
+    // If operand is temporary, operator works in its memory and moves it to result,
+    // so a * b + c * d - e makes no numbers except two products
+    BigInt operator+(BigInt&&, const BigInt&);
+    BigInt operator+(const BigInt&, BigInt&&);
+    BigInt operator+(BigInt&&, BigInt&&);
+    BigInt operator-(BigInt&&, const BigInt&);
+    BigInt operator-(const BigInt&, BigInt&&);
+    BigInt operator-(BigInt&&, BigInt&&);
+    BigInt operator^(BigInt&&, const BigInt&);
+    BigInt operator^(const BigInt&, BigInt&&);
+    BigInt operator^(BigInt&&, BigInt&&);
+    BigInt operator&(BigInt&&, const BigInt&);
+    BigInt operator&(const BigInt&, BigInt&&);
+    BigInt operator&(BigInt&&, BigInt&&);
+    BigInt operator|(BigInt&&, const BigInt&);
+    BigInt operator|(const BigInt&, BigInt&&);
+    BigInt operator|(BigInt&&, BigInt&&);
+
+    // Bit shifts (see BigInt::operator<<=) make copy of left operand with memory for result,
+    // temporary operand is shifted in its memory
+    BigInt operator<<(const BigInt&, size_t);
+    BigInt operator<<(BigInt&&, size_t);
+    BigInt operator>>(const BigInt&, size_t);
+    BigInt operator>>(BigInt&&, size_t);
+
+    // Ostream operator<< puts to_string(BigInt) to ostream, std::hex and std::oct give bases 16 and 8
     std::ostream& operator<<(std::ostream&, const BigInt&);
 
-    // Istream operator>> calls BigInt(std::string) and puts it to second argument
+    // Istream operator>> skips white spaces and reads sign and digits right from streambuf,
+    // first character after digits stays in stream, base is taken from std::hex and std::oct as for int
+    // No string with whole number is made: digits are converted by blocks while they are read (see RadixReader)
+    // Stream without digits gets failbit and number is not changed
     std::istream& operator>>(std::istream&,       BigInt&);
+
+    // Reads number as operator>>, but from FILE, returns false and does not change number if there are no digits
+    // Characters are taken from stdio buffer under one lock, so file is read by big blocks
+    // (use fdopen for file descriptor), wrong base calls std::invalid_argument
+    bool read_number(std::FILE*, BigInt&, unsigned base = 10);
+
+    // Writes number in system with base from 2 to 36 with digits 0-9 and a-z, '-' goes first for negative number
+    // prefix adds "0x", "0o" or "0b" after sign for bases 16, 8 and 2 (other bases have no prefix)
+    // Base 2^k takes one pass through limbs, other bases are converted as decimal system in operator std::string
+    // Wrong base calls std::invalid_argument
+    std::string to_string(const BigInt&, unsigned base = 10, bool prefix = false);
+
+    // Reads number in system with given base from 2 to 36, letters may be small or capital
+    // Sign and then prefix "0x", "0o" or "0b" of given base are allowed, base 0 takes base from prefix
+    // (and 10 if there is no prefix)
+    // Base 2^k takes one pass through digits, other bases are read as decimal system in BigInt(std::string)
+    // Wrong base or string, which is not a number, call std::invalid_argument
+    BigInt from_string(const std::string&, unsigned base = 10,
+                       std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+    // Binary import and export as with mpz_import and mpz_export, but with bytes only
+    // Unsigned format keeps magnitude (sign is lost), signed one keeps number in two's complement
+    // Little-endian export of magnitude on little-endian host is one memcpy of limbs
+
+    // Returns minimal number of bytes for export_bytes, zero takes no bytes in unsigned format
+    size_t export_size(const BigInt&, bool isSigned = false);
+
+    // Writes number to size bytes of dst in given order, free high bytes are filled with zeros
+    // (or with 0xff for negative number in signed format)
+    // size less than export_size calls std::invalid_argument
+    void export_bytes(uchar *dst, size_t size, const BigInt&,
+                      ByteOrder order = ByteOrder::little, bool isSigned = false);
+
+    // Reads number from size bytes of src in given order, in signed format high bit of number is its sign
+    BigInt import_bytes(const uchar *src, size_t size, ByteOrder order = ByteOrder::little, bool isSigned = false,
+                        std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+    // Limbs of number from digits of integer literal, they are found at compile time
+    // Base is taken from prefix as for built in literals: 0x or 0X (16), 0b or 0B (2), 0 (8), otherwise 10,
+    // ' separates digits, wrong digit stops compilation
+    template <char... Digits>
+    struct BigLiteral {
+        static constexpr char DIGITS[] = {Digits...};
+        static constexpr size_t LENGTH = sizeof...(Digits);
+
+        static constexpr unsigned BASE =
+                LENGTH > 1 && DIGITS[0] == '0' ? (DIGITS[1] | 0x20) == 'x' ? 16 : (DIGITS[1] | 0x20) == 'b' ? 2 : 8 : 10;
+        static constexpr size_t FIRST = BASE == 16 || BASE == 2 ? 2 : 0;
+
+        // Every digit takes at most 4 bits
+        static constexpr size_t CAPACITY = LENGTH * 4 / LIMB_WIDTH + 1;
+
+        // Horner's method by digits, every step multiplies all limbs by base
+        static constexpr std::array<limb, CAPACITY> parse() {
+            std::array<limb, CAPACITY> forRet{};
+            for (size_t i = FIRST; i < LENGTH; i++) {
+                const char c = DIGITS[i];
+                if (c == '\'') {
+                    continue;
+                }
+                const unsigned digit = c >= '0' && c <= '9' ? c - '0' : (c | 0x20) >= 'a' && (c | 0x20) <= 'f' ?
+                                                                        (c | 0x20) - 'a' + 10 : 16;
+                if (digit >= BASE) {
+                    throw std::invalid_argument("wrong digit in literal");
+                }
+                limb carry = digit;
+                for (limb &x: forRet) {
+                    const dlimb t = dlimb(x) * BASE + carry;
+                    x     = limb(t);
+                    carry = limb(t >> LIMB_WIDTH);
+                }
+            }
+            return forRet;
+        }
+
+        static constexpr std::array<limb, CAPACITY> LIMBS = parse();
+
+        static constexpr size_t size() {
+            size_t n = CAPACITY;
+            while (n > 0 && !LIMBS[n - 1]) {
+                n--;
+            }
+            return n;
+        }
+
+        // Non-owning view of limbs, which are kept in program, it takes no work at run time
+        static constexpr LimbView VIEW = {LIMBS.data(), size(), false};
+    };
+
+    inline namespace literals {
+        // Makes number from integer literal: 123_big, 0xffff'ffff'ffff'ffff'ffff_big, 0b101_big or 017_big
+        // (negative number is -123_big), no digits are parsed at run time: limbs from BigLiteral are only copied,
+        // so numbers up to LimbArray::INLINE_CAPACITY limbs take no memory from heap
+        template <char... Digits>
+        BigInt operator""_big() {
+            return BigInt(BigLiteral<Digits...>::VIEW);
+        }
+    }
 }
@@ -0,0 +1,224 @@
+#include "Combinatorics.h"
+#include "Kernels.h"
+
+#ifndef algorithm
+#include <algorithm>
+#endif
+
+#ifndef vector
+#include <vector>
+#endif
+
+namespace LongMath {
+    // Product of many single limb factors
+    // Halves of list are multiplied recursively, so both operands of every multiplication have
+    // about same length, and long products go to Karatsuba, Toom-3 or NTT
+    class ProductTree {
+    public:
+        // Returns product of n factors
+        static BigInt product(const limb *factors, size_t n);
+    };
+
+    BigInt ProductTree::product(const limb *factors, size_t n) {
+        if (n >= KARATSUBA_THRESHOLD) {
+            BigInt forRet(product(factors, n / 2));
+            forRet *= product(factors + n / 2, n - n / 2);
+            return forRet;
+        }
+
+        // Short product is found by multiplications by single limbs
+        BigInt forRet;
+        forRet.numberArr.resize(n + 1);
+        limb *const r = forRet.numberArr.data();
+        r[0] = 1;
+        for (size_t i = 0; i < n; i++) {
+            r[i + 1] = kernels::mul_1(r, r, i + 1, factors[i]);
+        }
+        forRet.fixMagnitude(false);
+        return forRet;
+    }
+
+    namespace {
+        size_t width(size_t x) {
+            return x ? LIMB_WIDTH - __builtin_clzll(x) : 0;
+        }
+
+        // Appends factor to list, small factors are joined while product fits in limb
+        void push(std::vector<limb> &factors, limb factor) {
+            if (!factors.empty() && factors.back() <= ~limb(0) / factor) {
+                factors.back() *= factor;
+            } else {
+                factors.push_back(factor);
+            }
+        }
+
+        BigInt product(const std::vector<limb> &factors) {
+            return ProductTree::product(factors.data(), factors.size());
+        }
+
+        // Sieve of Eratosthenes on odd numbers, returns odd primes up to n
+        std::vector<limb> oddPrimes(size_t n) {
+            std::vector<limb> forRet;
+            std::vector<bool> composite(n / 2 + 1);        // i-th element is for 2i + 1
+            for (size_t i = 1; 2 * i + 1 <= n; i++) {
+                if (composite[i]) {
+                    continue;
+                }
+                const size_t p = 2 * i + 1;
+                forRet.push_back(p);
+                if (p <= n / p) {
+                    for (size_t j = p * p; j <= n; j += 2 * p) {
+                        composite[j / 2] = true;
+                    }
+                }
+            }
+            return forRet;
+        }
+
+        // Odd part of swing(n) = n! / (n / 2)!^2
+        // Exponent of prime p is number of odd numbers among n / p, n / p^2, ..., so it is 1 for p in (n / 2, n],
+        // 0 for p in (n / 3, n / 2] and at most 1 for p > sqrt(n)
+        BigInt oddSwing(size_t n, const std::vector<limb> &primes) {
+            std::vector<limb> factors;
+            for (limb p: primes) {
+                if (p > n) {
+                    break;
+                }
+                limb power = 1;
+                for (size_t q = n / p; q; q /= p) {
+                    if (q & 1) {
+                        power *= p;
+                    }
+                }
+                if (power > 1) {
+                    push(factors, power);
+                }
+            }
+            return product(factors);
+        }
+
+        // Odd part of n!, odd(n) = odd(n / 2)^2 * odd part of swing(n)
+        BigInt oddFactorial(size_t n, const std::vector<limb> &primes) {
+            if (n < 3) {
+                return ONE;
+            }
+            const BigInt half(oddFactorial(n / 2, primes));
+            BigInt forRet;
+            mul(forRet, half, half);
+            forRet *= oddSwing(n, primes);
+            return forRet;
+        }
+
+        // Writes F(n) and L(n) to f and l
+        void fibonacciLucas(BigInt &f, BigInt &l, size_t n) {
+            const BigInt two(2);
+            BigInt t;
+            f = ZERO;
+            l = two;
+            for (size_t i = width(n); i > 0; i--) {
+                // (F(k), L(k)) -> (F(2k), L(2k)) for k = n >> i
+                mul(t, f, l);
+                std::swap(f, t);
+                mul(t, l, l);
+                std::swap(l, t);
+                if ((n >> i) & 1) {
+                    l += two;
+                } else {
+                    l -= two;
+                }
+
+                if ((n >> (i - 1)) & 1) {
+                    // F(2k + 1) = (F(2k) + L(2k)) / 2, L(2k + 1) = F(2k + 1) + 2 F(2k)
+                    add(t, f, l);
+                    t >>= 1;
+                    f <<= 1;
+                    add(l, t, f);
+                    std::swap(f, t);
+                }
+            }
+        }
+    }
+
+    BigInt factorial(size_t n) {
+        // Power of 2 in n! is n minus number of ones in binary n
+        return oddFactorial(n, oddPrimes(n)) << (n - __builtin_popcountll(n));
+    }
+
+    BigInt binomial(size_t n, size_t k) {
+        if (k > n) {
+            return ZERO;
+        }
+        k = std::min(k, n - k);
+        if (k == 0) {
+            return ONE;
+        }
+
+        std::vector<limb> factors;
+        if (n / k > 64) {
+            // Sieve up to n is too long here, and numerator is not much longer than result
+            for (size_t i = 0; i < k; i++) {
+                push(factors, n - i);
+            }
+            return product(factors) / factorial(k);
+        }
+
+        // Exponent of p is sum of n / p^i - k / p^i - (n - k) / p^i (number of borrows in n - k in base p),
+        // so p^e <= n; for p = 2 it is number of ones in k and n - k without number of ones in n
+        for (limb p: oddPrimes(n)) {
+            limb power = 1;
+            for (size_t q = p;; q *= p) {
+                for (size_t e = n / q - k / q - (n - k) / q; e; e--) {
+                    power *= p;
+                }
+                if (q > n / p) {
+                    break;
+                }
+            }
+            if (power > 1) {
+                push(factors, power);
+            }
+        }
+        return product(factors) << (__builtin_popcountll(k) + __builtin_popcountll(n - k) - __builtin_popcountll(n));
+    }
+
+    BigInt fibonacci(size_t n) {
+        if (!n) {
+            return ZERO;
+        }
+        BigInt f;
+        BigInt l;
+        fibonacciLucas(f, l, n / 2);
+        if (!(n & 1)) {
+            return f * l;
+        }
+        // F(2k + 1) = F(k)^2 + F(k + 1)^2, F(k + 1) = (F(k) + L(k)) / 2
+        BigInt next(f + l);
+        next >>= 1;
+        BigInt forRet;
+        mul(forRet, f, f);
+        addmul(forRet, next, next);
+        return forRet;
+    }
+
+    BigInt lucas(size_t n) {
+        BigInt f;
+        BigInt l;
+        fibonacciLucas(f, l, n / 2);
+        const BigInt sign((n / 2) & 1 ? -1 : 1);
+        BigInt forRet;
+        if (!(n & 1)) {
+            // L(2k) = L(k)^2 - 2(-1)^k
+            mul(forRet, l, l);
+            forRet -= sign + sign;
+            return forRet;
+        }
+        // L(2k + 1) = L(k) L(k + 1) - (-1)^k, L(k + 1) = (5F(k) + L(k)) / 2
+        BigInt next(f << 2);
+        next += f;
+        next += l;
+        next >>= 1;
+        mul(forRet, l, next);
+        forRet -= sign;
+        return forRet;
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "BigInt.h"
+
+namespace LongMath
+{
+    // Returns n!
+    // Luschny's prime swing: n! = (n / 2)!^2 * swing(n), where swing(n) = n! / (n / 2)!^2
+    // is made of prime powers found from n only, power of 2 is put by one shift
+    // Factors are joined in limbs and multiplied by balanced product tree,
+    // so big multiplications take numbers of same length (see mul)
+    BigInt factorial(size_t n);
+
+    // Returns binomial coefficient C(n, k), C(n, k) = 0 if k > n
+    // Exponents of primes are found by Legendre's formula and powers are multiplied by product tree,
+    // small k (compared with n) takes product of n - k + 1, ..., n divided by k! instead
+    BigInt binomial(size_t n, size_t k);
+
+    // Returns Fibonacci number F(n) and Lucas number L(n) (F(0) = 0, F(1) = 1, L(0) = 2, L(1) = 1)
+    // Fast doubling: F(2k) = F(k) L(k), L(2k) = L(k)^2 - 2(-1)^k, so every bit of n
+    // takes one multiplication and one squaring
+    BigInt fibonacci(size_t n);
+    BigInt lucas(size_t n);
+}
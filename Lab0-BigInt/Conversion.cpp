@@ -0,0 +1,419 @@
+#include "Kernels.h"
+
+#ifndef algorithm
+#include <algorithm>
+#endif
+
+#ifndef array
+#include <array>
+#endif
+
+#ifndef cmath
+#include <cmath>
+#endif
+
+#ifndef deque
+#include <deque>
+#endif
+
+#ifndef mutex
+#include <mutex>
+#endif
+
+#ifndef vector
+#include <vector>
+#endif
+
+// Conversion of magnitudes to and from system with base from 2 to 36
+// Digit of base 2^k is k bits of number, so these bases are converted in one pass through limbs
+// Other bases work by chunks: chunk is the biggest power of base in one limb (10^19 for decimal system)
+// Small numbers are divided by chunk again and again,
+// big ones are divided by chunk^(2^k) with about half of their digits,
+// and both parts are converted recursively
+// Parsing goes in reverse order: chunks of digits are read to one limb by Horner's method,
+// long strings are split in halves, which are joined by multiplication by chunk^(2^k)
+namespace LongMath::kernels {
+    namespace {
+        constexpr char DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+        struct Radix {
+            limb   chunkBase;       // base^chunkDigits
+            size_t chunkDigits;     // Number of digits in one limb
+            unsigned bits;          // k for base 2^k, otherwise 0
+        };
+
+        constexpr auto RADIXES = [] {
+            std::array<Radix, 37> forRet{};
+            for (unsigned base = 2; base <= 36; base++) {
+                Radix &radix = forRet[base];
+                radix.chunkBase = base;
+                radix.chunkDigits = 1;
+                while (radix.chunkBase <= ~limb(0) / base) {
+                    radix.chunkBase *= base;
+                    radix.chunkDigits++;
+                }
+                if (!(base & (base - 1))) {
+                    while ((1u << radix.bits) < base) {
+                        radix.bits++;
+                    }
+                }
+            }
+            return forRet;
+        }();
+
+        // DIGIT_VALUES[c] is value of digit c (small and capital letters are same)
+        constexpr auto DIGIT_VALUES = [] {
+            std::array<uchar, 256> forRet{};
+            for (unsigned i = 0; i < 36; i++) {
+                forRet[uchar(DIGITS[i])] = uchar(i);
+                forRet[uchar(DIGITS[i] & ~0x20)] = uchar(i);
+            }
+            return forRet;
+        }();
+
+        unsigned digitValue(char c) {
+            return DIGIT_VALUES[uchar(c)];
+        }
+
+        // Power chunk^(2^k) with data for division by it
+        struct RadixPower {
+            std::vector<limb> value;        // Without lead zero limbs
+            std::vector<limb> normalized;   // value << shift, so lead bit is set
+            unsigned shift;
+            std::vector<limb> inverse;      // Reciprocal of normalized value (see invert)
+            size_t digits;                  // chunkDigits * 2^k
+        };
+
+        // Powers are computed once for every base and kept for all next calls
+        // std::deque does not move its elements, so references stay valid while it grows
+        const RadixPower &radixPower(unsigned base, size_t k) {
+            static std::array<std::deque<RadixPower>, 37> powersOf;
+            static std::mutex guard;
+
+            std::lock_guard<std::mutex> lock(guard);
+            std::deque<RadixPower> &powers = powersOf[base];
+            while (powers.size() <= k) {
+                RadixPower next;
+                if (powers.empty()) {
+                    next.value  = {RADIXES[base].chunkBase};
+                    next.digits = RADIXES[base].chunkDigits;
+                } else {
+                    const RadixPower &last = powers.back();
+                    const size_t n = last.value.size();
+                    next.value.resize(2 * n);
+                    mul(next.value.data(), last.value.data(), n, last.value.data(), n);
+                    next.value.resize(normalizedSize(next.value.data(), 2 * n));
+                    next.digits = 2 * last.digits;
+                }
+
+                const size_t n = next.value.size();
+                next.shift = __builtin_clzll(next.value[n - 1]);
+                next.normalized = next.value;
+                if (next.shift) {
+                    lshift(next.normalized.data(), next.value.data(), n, next.shift);
+                }
+                next.inverse.resize(n + 1);
+                invert(next.inverse.data(), next.normalized.data(), n);
+                powers.push_back(std::move(next));
+            }
+            return powers[k];
+        }
+
+        // Digits of base 2^bits are taken from low bits to high ones,
+        // bits, which are not taken yet, are kept in acc
+        void toPowerOfTwo(char *s, size_t width, const limb *a, size_t n, unsigned bits) {
+            const limb mask = (limb(1) << bits) - 1;
+            limb acc = 0;
+            unsigned have = 0;
+            size_t i = 0;
+            for (size_t position = width; position > 0; position--) {
+                limb digit;
+                if (have >= bits) {
+                    digit = acc & mask;
+                    acc >>= bits;
+                    have -= bits;
+                } else {
+                    // Digit takes rest of acc and low bits of next limb
+                    const limb next = i < n ? a[i] : 0;
+                    i++;
+                    digit = (acc | (next << have)) & mask;
+                    acc   = next >> (bits - have);
+                    have  = LIMB_WIDTH - (bits - have);
+                }
+                s[position - 1] = DIGITS[digit];
+            }
+        }
+
+        // Digits are put to limbs from the last one
+        size_t fromPowerOfTwo(limb *r, const char *s, size_t length, unsigned bits) {
+            const size_t n = (length * bits + LIMB_WIDTH - 1) / LIMB_WIDTH;
+            limb acc = 0;
+            unsigned have = 0;
+            size_t i = 0;
+            for (size_t position = length; position > 0; position--) {
+                const limb digit = digitValue(s[position - 1]);
+                acc  |= digit << have;
+                have += bits;
+                if (have >= LIMB_WIDTH) {
+                    // High bits of digit go to next limb
+                    r[i++] = acc;
+                    have  -= LIMB_WIDTH;
+                    acc    = have ? digit >> (bits - have) : 0;
+                }
+            }
+            if (have) {
+                r[i++] = acc;
+            }
+            std::fill(r + i, r + n, 0);
+            return normalizedSize(r, n);
+        }
+
+        // Writes chunks of digits from remainders of division by chunk
+        void toRadixBasecase(char *s, size_t width, const limb *a, size_t n, unsigned base) {
+            const Radix &radix = RADIXES[base];
+            std::vector<limb> rest(a, a + n);
+            size_t position = width;
+            while (n > 0 && position > 0) {
+                limb chunk = divrem_1(rest.data(), rest.data(), n, radix.chunkBase);
+                n = normalizedSize(rest.data(), n);
+                for (size_t i = 0; i < radix.chunkDigits && position > 0; i++) {
+                    s[--position] = DIGITS[chunk % base];
+                    chunk /= base;
+                }
+            }
+            std::fill(s, s + position, '0');
+        }
+
+        // Horner's method by chunks of digits, first chunk takes rest of digits
+        size_t fromRadixBasecase(limb *r, const char *s, size_t length, unsigned base) {
+            const Radix &radix = RADIXES[base];
+            size_t n = 0;
+            for (size_t i = 0; i < length;) {
+                const size_t chunkLength = i ? radix.chunkDigits : (length - 1) % radix.chunkDigits + 1;
+                limb chunk = 0;
+                limb scale = 1;
+                for (size_t j = 0; j < chunkLength; j++) {
+                    chunk  = chunk * base + digitValue(s[i + j]);
+                    scale *= base;
+                }
+                i += chunkLength;
+
+                r[n] = mul_1(r, r, n, scale);
+                add(r, r, n + 1, &chunk, 1);
+                n = normalizedSize(r, n + 1);
+            }
+            return n;
+        }
+
+        // q = a / power, r = a % power, an >= power length m,
+        // q has length an - m + 2, r has length m
+        void divremPower(limb *q, limb *r, const limb *a, size_t an, const RadixPower &power) {
+            const size_t m = power.value.size();
+            if (m < BARRETT_THRESHOLD) {
+                q[an - m + 1] = 0;
+                divrem(q, r, a, an, power.value.data(), m);
+                return;
+            }
+
+            // Reciprocal is known already, so only Barrett's reduction is left
+            std::vector<limb> shifted(a, a + an);
+            shifted.push_back(0);
+            if (power.shift) {
+                shifted[an] = lshift(shifted.data(), a, an, power.shift);
+            }
+            divrem_preinv(q, r, shifted.data(), an + 1, power.normalized.data(), m, power.inverse.data());
+            if (power.shift) {
+                rshift(r, r, m, power.shift);
+            }
+        }
+
+        std::vector<limb> digitsToLimbs(const char *s, size_t length, unsigned base) {
+            std::vector<limb> forRet(radix_limbs(length, base) + 1);
+            forRet.resize(from_radix(forRet.data(), s, length, base));
+            return forRet;
+        }
+
+        // base^digits as product of cached powers for set bits of digits / chunkDigits and power for rest of digits
+        std::vector<limb> powerOf(unsigned base, size_t digits) {
+            const size_t chunkDigits = RADIXES[base].chunkDigits;
+            std::vector<limb> forRet{1};
+            for (size_t i = 0; i < digits % chunkDigits; i++) {
+                forRet[0] *= base;
+            }
+            std::vector<limb> product;
+            for (size_t k = 0, chunks = digits / chunkDigits; chunks; k++, chunks >>= 1) {
+                if (chunks & 1) {
+                    const std::vector<limb> &power = radixPower(base, k).value;
+                    product.resize(forRet.size() + power.size());
+                    mul(product.data(), forRet.data(), forRet.size(), power.data(), power.size());
+                    product.resize(normalizedSize(product.data(), product.size()));
+                    std::swap(forRet, product);
+                }
+            }
+            return forRet;
+        }
+
+        // Returns high * base^digits + low, low < base^digits, both numbers have no lead zero limbs
+        std::vector<limb> join(const std::vector<limb> &high, const std::vector<limb> &low,
+                               size_t digits, unsigned base) {
+            if (high.empty()) {
+                return low;
+            }
+            std::vector<limb> forRet;
+            if (RADIXES[base].bits) {
+                // Power of two only moves high part
+                const size_t shift = digits * RADIXES[base].bits;
+                forRet.assign(shift / LIMB_WIDTH + high.size() + 1, 0);
+                limb *const r = forRet.data() + shift / LIMB_WIDTH;
+                if (shift % LIMB_WIDTH) {
+                    r[high.size()] = lshift(r, high.data(), high.size(), shift % LIMB_WIDTH);
+                } else {
+                    std::copy(high.begin(), high.end(), r);
+                }
+            } else {
+                const std::vector<limb> power(powerOf(base, digits));
+                forRet.resize(high.size() + power.size());
+                mul(forRet.data(), high.data(), high.size(), power.data(), power.size());
+            }
+            // Low part is less than power, so it is not longer than product
+            if (!low.empty()) {
+                add(forRet.data(), forRet.data(), forRet.size(), low.data(), low.size());
+            }
+            forRet.resize(normalizedSize(forRet.data(), forRet.size()));
+            return forRet;
+        }
+    }
+
+    size_t radix_size(const limb *a, size_t n, unsigned base) {
+        n = normalizedSize(a, n);
+        if (!n) {
+            return 1;
+        }
+        const size_t bits = n * LIMB_WIDTH - __builtin_clzll(a[n - 1]);
+        if (RADIXES[base].bits) {
+            return (bits + RADIXES[base].bits - 1) / RADIXES[base].bits;
+        }
+        // Number has less than bits * log(2) / log(base) + 1 digits, one more digit covers rounding
+        return size_t(double(bits) / std::log2(double(base))) + 2;
+    }
+
+    void to_radix(char *s, size_t width, const limb *a, size_t n, unsigned base) {
+        n = normalizedSize(a, n);
+        if (RADIXES[base].bits) {
+            toPowerOfTwo(s, width, a, n, RADIXES[base].bits);
+            return;
+        }
+        if (n < std::max<size_t>(RADIX_CONVERSION_THRESHOLD, 2)) {
+            toRadixBasecase(s, width, a, n, base);
+            return;
+        }
+
+        // Biggest power with no more than half of digits
+        const size_t chunkDigits = RADIXES[base].chunkDigits;
+        size_t k = 0;
+        while (2 * (chunkDigits << (k + 1)) <= width) {
+            k++;
+        }
+        const RadixPower &power = radixPower(base, k);
+        const size_t m = power.value.size();
+        const size_t low = std::min(power.digits, width);
+
+        if (n < m) {
+            // Number is less than power, so its high part is zero
+            std::fill(s, s + width - low, '0');
+            to_radix(s + width - low, low, a, n, base);
+            return;
+        }
+
+        std::vector<limb> q(n - m + 2);
+        std::vector<limb> r(m);
+        divremPower(q.data(), r.data(), a, n, power);
+        to_radix(s,               width - low, q.data(), q.size(), base);
+        to_radix(s + width - low, low,         r.data(), m,        base);
+    }
+
+    size_t radix_limbs(size_t digits, unsigned base) {
+        return digits / RADIXES[base].chunkDigits + 1;
+    }
+
+    size_t from_radix(limb *r, const char *s, size_t length, unsigned base) {
+        if (RADIXES[base].bits) {
+            return fromPowerOfTwo(r, s, length, RADIXES[base].bits);
+        }
+        const size_t chunkDigits = RADIXES[base].chunkDigits;
+        if (length < chunkDigits * std::max<size_t>(RADIX_CONVERSION_THRESHOLD, 2)) {
+            return fromRadixBasecase(r, s, length, base);
+        }
+
+        // Biggest power with no more than half of digits: number = high * base^digits + low
+        size_t k = 0;
+        while (2 * (chunkDigits << (k + 1)) <= length) {
+            k++;
+        }
+        const RadixPower &power = radixPower(base, k);
+        std::vector<limb> high(radix_limbs(length - power.digits, base));
+        std::vector<limb> low (radix_limbs(power.digits, base));
+        const size_t highLength = from_radix(high.data(), s, length - power.digits, base);
+        const size_t lowLength  = from_radix(low.data(), s + length - power.digits, power.digits, base);
+        if (!highLength) {
+            std::copy(low.begin(), low.begin() + lowLength, r);
+            return lowLength;
+        }
+
+        // Power has no more than digits / chunkDigits limbs, so product fits in r
+        const size_t m = power.value.size();
+        mul(r, high.data(), highLength, power.value.data(), m);
+        add(r, r, highLength + m, low.data(), lowLength);
+        return normalizedSize(r, highLength + m);
+    }
+
+    RadixReader::RadixReader(unsigned base) :
+            base(base),
+            blockDigits(RADIXES[base].chunkDigits << 6) {
+        block.reserve(blockDigits);
+    }
+
+    void RadixReader::append(const char *s, size_t length) {
+        while (length) {
+            if (block.empty() && length >= blockDigits) {
+                // Whole block is converted in place
+                push(s);
+                s      += blockDigits;
+                length -= blockDigits;
+                continue;
+            }
+            const size_t taken = std::min(length, blockDigits - block.size());
+            block.append(s, taken);
+            s      += taken;
+            length -= taken;
+            if (block.size() == blockDigits) {
+                push(block.data());
+                block.clear();
+            }
+        }
+    }
+
+    void RadixReader::push(const char *s) {
+        Part next{digitsToLimbs(s, blockDigits, base), blockDigits};
+        // Parts are joined as carries of binary counter, so every digit takes part in log of joins
+        while (!parts.empty() && parts.back().digits == next.digits) {
+            next.value   = join(parts.back().value, next.value, next.digits, base);
+            next.digits *= 2;
+            parts.pop_back();
+        }
+        parts.push_back(std::move(next));
+    }
+
+    std::vector<limb> RadixReader::finish() {
+        std::vector<limb> forRet(digitsToLimbs(block.data(), block.size(), base));
+        size_t digits = block.size();
+        // Newer parts are lower
+        for (size_t i = parts.size(); i > 0; i--) {
+            forRet  = join(parts[i - 1].value, forRet, digits, base);
+            digits += parts[i - 1].digits;
+        }
+        block.clear();
+        parts.clear();
+        return forRet;
+    }
+}
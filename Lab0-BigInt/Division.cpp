@@ -0,0 +1,296 @@
+#include "Kernels.h"
+
+#ifndef algorithm
+#include <algorithm>
+#endif
+
+#ifndef vector
+#include <vector>
+#endif
+
+// Division of magnitudes
+// Short divisors use Knuth's algorithm D, long ones use Barrett's reduction
+// with reciprocal of divisor, which is found by Newton's iteration
+namespace LongMath::kernels {
+    namespace {
+        // Knuth's algorithm D (The Art of Computer Programming, vol. 2, 4.3.1)
+        void divremKnuth(limb *q, limb *r, const limb *u, size_t un, const limb *v, size_t vn) {
+            if (vn == 1) {
+                r[0] = divrem_1(q, u, un, v[0]);
+                return;
+            }
+
+            // Normalization: divisor's lead bit must be set for good estimation of quotient digit
+            // Buffers are kept between calls, so short divisions do not allocate
+            const unsigned shift = __builtin_clzll(v[vn - 1]);
+            thread_local std::vector<limb> vs;
+            thread_local std::vector<limb> us;
+            vs.assign(v, v + vn);
+            us.assign(u, u + un);
+            us.push_back(0);
+            if (shift) {
+                lshift(vs.data(), v, vn, shift);
+                us[un] = lshift(us.data(), u, un, shift);
+            }
+
+            const limb vHigh = vs[vn - 1];
+            const limb vLow  = vs[vn - 2];
+            for (size_t j = un - vn + 1; j > 0; j--) {
+                limb *const window = us.data() + j - 1;
+
+                // Estimation of quotient digit by two lead limbs, it is at most 2 more than real one
+                const dlimb top = (dlimb(window[vn]) << LIMB_WIDTH) | window[vn - 1];
+                dlimb qHat = top / vHigh;
+                dlimb rHat = top % vHigh;
+                while (qHat > LIMB_MAX ||
+                       qHat * vLow > ((rHat << LIMB_WIDTH) | window[vn - 2])) {
+                    qHat--;
+                    rHat += vHigh;
+                    if (rHat > LIMB_MAX) {
+                        break;
+                    }
+                }
+
+                const limb borrow = submul_1(window, vs.data(), vn, limb(qHat));
+                const bool negative = window[vn] < borrow;
+                window[vn] -= borrow;
+
+                // Estimation was 1 more than real digit, so add divisor back
+                if (negative) {
+                    qHat--;
+                    window[vn] += add_n(window, window, vs.data(), vn);
+                }
+                q[j - 1] = limb(qHat);
+            }
+
+            if (shift) {
+                rshift(r, us.data(), vn, shift);
+            } else {
+                std::copy(us.begin(), us.begin() + vn, r);
+            }
+        }
+
+        // Adds 1 to a with length n, returns carry
+        limb increment(limb *a, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                if (++a[i]) {
+                    return 0;
+                }
+            }
+            return 1;
+        }
+
+        // Subtracts 1 from a with length n, returns borrow
+        limb decrement(limb *a, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                if (a[i]--) {
+                    return 0;
+                }
+            }
+            return 1;
+        }
+
+        // Compares a (length an) with d (length n), an >= n
+        int compareLong(const limb *a, size_t an, const limb *d, size_t n) {
+            if (normalizedSize(a, an) > n) {
+                return 1;
+            }
+            return cmp(a, d, n);
+        }
+
+        // One step of Barrett's reduction (Handbook of Applied Cryptography, 14.42):
+        // q = x / d (m limbs), r = x % d (n limbs) for x with length n + m, m <= n and x < d * B^m
+        void barrettStep(limb *q, limb *r, const limb *x, size_t m,
+                         const limb *d, size_t n, const limb *inv) {
+            // q3 = ((x / B^(n - 1)) * inv) / B^(n + 1), it is at most 2 less than real quotient
+            std::vector<limb> q2(n + m + 2);
+            mul(q2.data(), x + n - 1, m + 1, inv, n + 1);
+            limb *const q3 = q2.data() + n + 1;
+
+            std::vector<limb> product(n + m + 1);
+            mul(product.data(), q3, m + 1, d, n);
+            std::vector<limb> rest(n + m);
+            sub_n(rest.data(), x, product.data(), n + m);
+
+            while (compareLong(rest.data(), n + m, d, n) >= 0) {
+                sub(rest.data(), rest.data(), n + m, d, n);
+                increment(q3, m + 1);
+            }
+            std::copy(q3, q3 + m, q);
+            std::copy(rest.begin(), rest.begin() + n, r);
+        }
+    }
+
+    void invert(limb *inv, const limb *d, size_t n) {
+        if (n <= 1 || n < BARRETT_THRESHOLD) {
+            const std::vector<limb> u(2 * n, LIMB_MAX);
+            std::vector<limb> r(n);
+            divremKnuth(inv, r.data(), u.data(), 2 * n, d, n);
+            return;
+        }
+
+        // Approximation x0 = vh * B^l, where vh is reciprocal of h lead limbs of d
+        const size_t h = (n + 1) / 2;
+        const size_t l = n - h;
+        std::vector<limb> x(n + 2, 0);
+        limb *const vh = x.data() + l;
+        invert(vh, d + l, h);
+
+        // Newton's step x1 = x0 + x0 * (B^2n - d * x0) / B^2n
+        // With e = B^(n + h) - d * vh it is x1 = vh * B^l + vh * e / B^2h
+        std::vector<limb> e(n + h + 1);
+        mul(e.data(), d, n, vh, h + 1);
+        bool negative = e[n + h] != 0;
+        if (negative) {
+            e[n + h]--;
+        } else {
+            const std::vector<limb> zero(n + h, 0);
+            sub_n(e.data(), zero.data(), e.data(), n + h);
+        }
+        const size_t eLength = normalizedSize(e.data(), e.size());
+        std::vector<limb> correction(h + 1 + eLength + 1, 0);
+        mul(correction.data(), vh, h + 1, e.data(), eLength);
+        if (correction.size() > 2 * h) {
+            const limb *const shifted = correction.data() + 2 * h;
+            const size_t length = std::min(correction.size() - 2 * h, x.size());
+            if (negative) {
+                sub(x.data(), x.data(), x.size(), shifted, length);
+            } else {
+                add(x.data(), x.data(), x.size(), shifted, length);
+            }
+        }
+
+        // Final correction, so 0 <= B^2n - 1 - d * x < d
+        std::vector<limb> product(2 * n + 2);
+        mul(product.data(), d, n, x.data(), n + 2);
+        std::vector<limb> target(2 * n + 2, 0);
+        std::fill(target.begin(), target.begin() + 2 * n, LIMB_MAX);
+        if (cmp(product.data(), target.data(), 2 * n + 2) <= 0) {
+            sub_n(target.data(), target.data(), product.data(), 2 * n + 2);
+            while (compareLong(target.data(), 2 * n + 2, d, n) >= 0) {
+                sub(target.data(), target.data(), 2 * n + 2, d, n);
+                increment(x.data(), n + 2);
+            }
+        } else {
+            // Remainder is negative, -target is its absolute value
+            sub_n(target.data(), product.data(), target.data(), 2 * n + 2);
+            while (normalizedSize(target.data(), 2 * n + 2)) {
+                decrement(x.data(), n + 2);
+                if (compareLong(target.data(), 2 * n + 2, d, n) <= 0) {
+                    break;
+                }
+                sub(target.data(), target.data(), 2 * n + 2, d, n);
+            }
+        }
+        std::copy(x.begin(), x.begin() + n + 1, inv);
+    }
+
+    void divrem_preinv(limb *q, limb *r, const limb *u, size_t un,
+                       const limb *d, size_t n, const limb *inv) {
+        // Remainder of lead limbs, then every step adds up to n lower limbs of u to it
+        size_t position = un - n;
+        std::vector<limb> window(2 * n);
+        limb *const rest = window.data() + n;
+        std::copy(u + position, u + un, rest);
+        q[position] = 0;
+        if (cmp(rest, d, n) >= 0) {
+            sub_n(rest, rest, d, n);
+            q[position] = 1;
+        }
+
+        while (position > 0) {
+            const size_t m = std::min(n, position);
+            position -= m;
+            limb *const x = rest - m;
+            std::copy(u + position, u + position + m, x);
+            barrettStep(q + position, rest, x, m, d, n, inv);
+        }
+        std::copy(rest, rest + n, r);
+    }
+
+    void divrem(limb *q, limb *r, const limb *u, size_t un, const limb *v, size_t vn) {
+        if (vn < BARRETT_THRESHOLD || un - vn + 1 < BARRETT_THRESHOLD) {
+            divremKnuth(q, r, u, un, v, vn);
+            return;
+        }
+
+        const unsigned shift = __builtin_clzll(v[vn - 1]);
+        std::vector<limb> vs(v, v + vn);
+        std::vector<limb> us(u, u + un);
+        us.push_back(0);
+        if (shift) {
+            lshift(vs.data(), v, vn, shift);
+            us[un] = lshift(us.data(), u, un, shift);
+        }
+
+        std::vector<limb> inv(vn + 1);
+        invert(inv.data(), vs.data(), vn);
+
+        std::vector<limb> qs(un - vn + 2);
+        std::vector<limb> rs(vn);
+        divrem_preinv(qs.data(), rs.data(), us.data(), un + 1, vs.data(), vn, inv.data());
+        std::copy(qs.begin(), qs.begin() + (un - vn + 1), q);
+        if (shift) {
+            rshift(r, rs.data(), vn, shift);
+        } else {
+            std::copy(rs.begin(), rs.end(), r);
+        }
+    }
+
+    limb mont_inverse(limb m0) {
+        // m0 * m0 = 1 mod 8 for odd m0, every Newton's step doubles number of right bits: 3, 6, ..., 96
+        limb x = m0;
+        for (int i = 0; i < 5; i++) {
+            x *= 2 - m0 * x;
+        }
+        return 0 - x;
+    }
+
+    void redc(limb *r, limb *t, const limb *m, size_t n, limb inv) {
+        // Every step adds multiple of m, which makes lower limb zero, so carry of step
+        // is kept in that limb and all carries are added to high half at once
+        for (size_t i = 0; i < n; i++) {
+            t[i] = addmul_1(t + i, m, n, t[i] * inv);
+        }
+        // Now t / B^n < 2m, so one subtraction is enough
+        const limb top = add_n(r, t + n, t, n);
+        if (top || cmp(r, m, n) >= 0) {
+            sub_n(r, r, m, n);
+        }
+    }
+
+    size_t mont_scratch_size(size_t n) {
+        return 2 * n + mul_scratch_size(n, n);
+    }
+
+    void mont_mul(limb *r, const limb *a, const limb *b, const limb *m, size_t n, limb inv, limb *t) {
+        if (n >= KARATSUBA_THRESHOLD) {
+            mul_scratch(t, a, n, b, n, t + 2 * n);
+            redc(r, t, m, n, inv);
+            return;
+        }
+
+        // Row i adds a * b[i] and multiple of m, which makes limb i zero, so t + i + 1 is sum
+        // divided by B^(i + 1), it is less than 2m, so high limb above row is 0 or 1
+        std::fill(t, t + n, 0);
+        limb high = 0;
+        for (size_t i = 0; i < n; i++) {
+            const limb product = addmul_1(t + i, a, n, b[i]);
+            const limb q       = t[i] * inv;
+            const dlimb top    = dlimb(high) + product + addmul_1(t + i, m, n, q);
+            t[i + n] = limb(top);
+            high     = limb(top >> LIMB_WIDTH);
+        }
+        if (high || cmp(t + n, m, n) >= 0) {
+            sub_n(r, t + n, m, n);
+        } else {
+            std::copy(t + n, t + 2 * n, r);
+        }
+    }
+
+    void mont_sqr(limb *r, const limb *a, const limb *m, size_t n, limb inv, limb *t) {
+        // Same pointers make mul_scratch square
+        mul_scratch(t, a, n, a, n, t + 2 * n);
+        redc(r, t, m, n, inv);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,436 @@
+#pragma once
+
+#include "BigInt.h"
+
+#ifndef array
+#include <array>
+#endif
+
+#ifndef type_traits
+#include <type_traits>
+#endif
+
+namespace LongMath
+{
+    // Integer with fixed number of bits, which keeps its limbs inside object in std::array
+    // Number is in two's complement and every operation is modulo 2^Bits as with built in types,
+    // Signed gives sign to lead bit for comparisons, division, operator>>= and conversion to BigInt
+    // There is no memory allocation and no lead limbs to purge, every loop has length known at compile time,
+    // so compiler unrolls it, and all arithmetic is constexpr
+    template <size_t Bits, bool Signed = true>
+    class FixedInt {
+        static_assert(Bits > 0 && Bits % LIMB_WIDTH == 0, "FixedInt takes whole limbs");
+
+    public:
+        static constexpr size_t LIMBS = Bits / LIMB_WIDTH;
+
+        // Constructors
+
+        // Default constructor makes zero
+        constexpr FixedInt() = default;
+        // Converts built in integer, negative number is extended by sign
+        template <class T, std::enable_if_t<std::is_integral<T>::value, int> = 0>
+        constexpr explicit FixedInt(T x) {
+            limbs[0] = limb(x);
+            if (std::is_signed<T>::value && x < T(0)) {
+                for (size_t i = 1; i < LIMBS; i++) {
+                    limbs[i] = ~limb(0);
+                }
+            }
+        }
+        // Takes limbs of number in two's complement, lower limb goes first
+        constexpr explicit FixedInt(const std::array<limb, LIMBS> &numberA) :
+                limbs(numberA) {}
+        // Takes low Bits of BigInt in two's complement, so number out of range is wrapped as with static_cast
+        explicit FixedInt(const BigInt &);
+
+        //
+        // Math operators
+        //
+
+        constexpr FixedInt operator~() const {
+            FixedInt forRet;
+            for (size_t i = 0; i < LIMBS; i++) {
+                forRet.limbs[i] = ~limbs[i];
+            }
+            return forRet;
+        }
+
+        constexpr FixedInt &operator++() {
+            for (size_t i = 0; i < LIMBS && !++limbs[i]; i++) {}
+            return *this;
+        }
+
+        constexpr FixedInt &operator--() {
+            for (size_t i = 0; i < LIMBS && !limbs[i]--; i++) {}
+            return *this;
+        }
+
+        constexpr FixedInt operator++(int) {
+            const FixedInt forRet(*this);
+            ++*this;
+            return forRet;
+        }
+
+        constexpr FixedInt operator--(int) {
+            const FixedInt forRet(*this);
+            --*this;
+            return forRet;
+        }
+
+        // Carry goes through double limb
+        constexpr FixedInt &operator+=(const FixedInt &numberFI) {
+            limb carry = 0;
+            for (size_t i = 0; i < LIMBS; i++) {
+                const dlimb sum = dlimb(limbs[i]) + numberFI.limbs[i] + carry;
+                limbs[i] = limb(sum);
+                carry    = limb(sum >> LIMB_WIDTH);
+            }
+            return *this;
+        }
+
+        constexpr FixedInt &operator-=(const FixedInt &numberFI) {
+            limb borrow = 0;
+            for (size_t i = 0; i < LIMBS; i++) {
+                const dlimb difference = dlimb(limbs[i]) - numberFI.limbs[i] - borrow;
+                limbs[i] = limb(difference);
+                borrow   = limb(difference >> LIMB_WIDTH) & 1;
+            }
+            return *this;
+        }
+
+        // Default strikingly multiplication, which finds only low LIMBS limbs of product
+        // Two's complement product has same low limbs as product of magnitudes, so sign is not checked
+        constexpr FixedInt &operator*=(const FixedInt &numberFI) {
+            FixedInt product;
+            for (size_t i = 0; i < LIMBS; i++) {
+                limb carry = 0;
+                for (size_t j = 0; i + j < LIMBS; j++) {
+                    const dlimb t = dlimb(limbs[i]) * numberFI.limbs[j] + product.limbs[i + j] + carry;
+                    product.limbs[i + j] = limb(t);
+                    carry = limb(t >> LIMB_WIDTH);
+                }
+            }
+            return *this = product;
+        }
+
+        // Division works as for BigInt (see divmod below)
+        constexpr FixedInt &operator/=(const FixedInt &numberFI) {
+            FixedInt remainder;
+            divmod(*this, remainder, *this, numberFI);
+            return *this;
+        }
+
+        constexpr FixedInt &operator%=(const FixedInt &numberFI) {
+            FixedInt quotient;
+            divmod(quotient, *this, *this, numberFI);
+            return *this;
+        }
+
+        constexpr FixedInt &operator^=(const FixedInt &numberFI) {
+            for (size_t i = 0; i < LIMBS; i++) {
+                limbs[i] ^= numberFI.limbs[i];
+            }
+            return *this;
+        }
+
+        constexpr FixedInt &operator&=(const FixedInt &numberFI) {
+            for (size_t i = 0; i < LIMBS; i++) {
+                limbs[i] &= numberFI.limbs[i];
+            }
+            return *this;
+        }
+
+        constexpr FixedInt &operator|=(const FixedInt &numberFI) {
+            for (size_t i = 0; i < LIMBS; i++) {
+                limbs[i] |= numberFI.limbs[i];
+            }
+            return *this;
+        }
+
+        // Shift by Bits and more gives zero, operator>>= of signed number gives -1 for negative one
+        constexpr FixedInt &operator<<=(size_t shift) {
+            const size_t j = shift / LIMB_WIDTH;
+            const unsigned k = shift % LIMB_WIDTH;
+            for (size_t i = LIMBS; i > 0; i--) {
+                const limb high = i - 1 >= j ? limbs[i - 1 - j] : 0;
+                const limb low  = i - 1 >= j + 1 ? limbs[i - 2 - j] : 0;
+                limbs[i - 1] = k ? (high << k) | (low >> (LIMB_WIDTH - k)) : high;
+            }
+            return *this;
+        }
+
+        constexpr FixedInt &operator>>=(size_t shift) {
+            const limb fill = isNegative() ? ~limb(0) : 0;
+            const size_t j = shift / LIMB_WIDTH;
+            const unsigned k = shift % LIMB_WIDTH;
+            for (size_t i = 0; i < LIMBS; i++) {
+                const limb low  = i + j < LIMBS ? limbs[i + j] : fill;
+                const limb high = i + j + 1 < LIMBS ? limbs[i + j + 1] : fill;
+                limbs[i] = k ? (low >> k) | (high << (LIMB_WIDTH - k)) : low;
+            }
+            return *this;
+        }
+
+        constexpr FixedInt operator+() const {
+            return *this;
+        }
+
+        constexpr FixedInt operator-() const {
+            FixedInt forRet(~*this);
+            return ++forRet;
+        }
+
+        constexpr bool operator==(const FixedInt &numberFI) const {
+            for (size_t i = 0; i < LIMBS; i++) {
+                if (limbs[i] != numberFI.limbs[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        constexpr bool operator!=(const FixedInt &numberFI) const {
+            return !(*this == numberFI);
+        }
+
+        // Signed numbers with different signs are compared by sign, otherwise limbs are compared from higher one
+        constexpr bool operator<(const FixedInt &numberFI) const {
+            if (isNegative() != numberFI.isNegative()) {
+                return isNegative();
+            }
+            for (size_t i = LIMBS; i > 0; i--) {
+                if (limbs[i - 1] != numberFI.limbs[i - 1]) {
+                    return limbs[i - 1] < numberFI.limbs[i - 1];
+                }
+            }
+            return false;
+        }
+
+        constexpr bool operator>(const FixedInt &numberFI) const {
+            return numberFI < *this;
+        }
+
+        constexpr bool operator<=(const FixedInt &numberFI) const {
+            return !(numberFI < *this);
+        }
+
+        constexpr bool operator>=(const FixedInt &numberFI) const {
+            return !(*this < numberFI);
+        }
+
+        // Turns low bits of number to built in integer
+        template <class T, std::enable_if_t<std::is_integral<T>::value, int> = 0>
+        constexpr explicit operator T() const {
+            return T(limbs[0]);
+        }
+
+        // Converts number with its sign, no bits are lost
+        explicit operator BigInt() const;
+
+        // Writes decimal digits as BigInt does
+        explicit operator std::string() const {
+            return std::string(BigInt(*this));
+        }
+
+        // Returns limbs of number in two's complement
+        [[nodiscard]] constexpr const std::array<limb, LIMBS> &getArray() const {
+            return limbs;
+        }
+
+        [[nodiscard]] constexpr bool isNegative() const {
+            return Signed && (limbs[LIMBS - 1] >> (LIMB_WIDTH - 1));
+        }
+
+        // q = a / b, r = a % b, quotient is rounded to zero and remainder has sign of a
+        // (for signed minimal number divided by -1 quotient is wrapped to itself as with two's complement)
+        // Magnitudes are divided by Knuth's algorithm D, division by zero calls std::invalid_argument
+        static constexpr void divmod(FixedInt &q, FixedInt &r, const FixedInt &a, const FixedInt &b) {
+            const bool negativeA = a.isNegative();
+            const bool negativeB = b.isNegative();
+            divmodMagnitudes(q.limbs, r.limbs, (negativeA ? -a : a).limbs, (negativeB ? -b : b).limbs);
+            if (negativeA != negativeB) {
+                q = -q;
+            }
+            if (negativeA) {
+                r = -r;
+            }
+        }
+
+        // Binary operators make copy of left operand and call compound operator
+
+        friend constexpr FixedInt operator+(FixedInt a, const FixedInt &b) {
+            return a += b;
+        }
+
+        friend constexpr FixedInt operator-(FixedInt a, const FixedInt &b) {
+            return a -= b;
+        }
+
+        friend constexpr FixedInt operator*(FixedInt a, const FixedInt &b) {
+            return a *= b;
+        }
+
+        friend constexpr FixedInt operator/(FixedInt a, const FixedInt &b) {
+            return a /= b;
+        }
+
+        friend constexpr FixedInt operator%(FixedInt a, const FixedInt &b) {
+            return a %= b;
+        }
+
+        friend constexpr FixedInt operator^(FixedInt a, const FixedInt &b) {
+            return a ^= b;
+        }
+
+        friend constexpr FixedInt operator&(FixedInt a, const FixedInt &b) {
+            return a &= b;
+        }
+
+        friend constexpr FixedInt operator|(FixedInt a, const FixedInt &b) {
+            return a |= b;
+        }
+
+        friend constexpr FixedInt operator<<(FixedInt a, size_t shift) {
+            return a <<= shift;
+        }
+
+        friend constexpr FixedInt operator>>(FixedInt a, size_t shift) {
+            return a >>= shift;
+        }
+
+        friend std::ostream &operator<<(std::ostream &out, const FixedInt &numberFI) {
+            return out << BigInt(numberFI);
+        }
+
+    private:
+        std::array<limb, LIMBS> limbs{};
+
+        static constexpr size_t normalizedSize(const limb *a, size_t n) {
+            while (n > 0 && !a[n - 1]) {
+                n--;
+            }
+            return n;
+        }
+
+        static constexpr unsigned leadZeros(limb x) {
+            unsigned forRet = 0;
+            for (; !(x >> (LIMB_WIDTH - 1)); x <<= 1) {
+                forRet++;
+            }
+            return forRet;
+        }
+
+        // Knuth's algorithm D on magnitudes: divisor and dividend are shifted,
+        // so lead bit of divisor is set, then every limb of quotient is estimated by two high limbs
+        static constexpr void divmodMagnitudes(std::array<limb, LIMBS> &q, std::array<limb, LIMBS> &r,
+                                               const std::array<limb, LIMBS> &a, const std::array<limb, LIMBS> &b) {
+            const size_t n = normalizedSize(b.data(), LIMBS);
+            if (!n) {
+                throw std::invalid_argument("division by zero");
+            }
+            const size_t m = normalizedSize(a.data(), LIMBS);
+            q = {};
+            r = {};
+            if (m < n) {
+                r = a;
+                return;
+            }
+
+            if (n == 1) {
+                limb rest = 0;
+                for (size_t i = m; i > 0; i--) {
+                    const dlimb t = (dlimb(rest) << LIMB_WIDTH) | a[i - 1];
+                    q[i - 1] = limb(t / b[0]);
+                    rest     = limb(t % b[0]);
+                }
+                r[0] = rest;
+                return;
+            }
+
+            const unsigned shift = leadZeros(b[n - 1]);
+            std::array<limb, LIMBS>     v{};
+            std::array<limb, LIMBS + 1> u{};
+            for (size_t i = n; i > 0; i--) {
+                v[i - 1] = shift ? (b[i - 1] << shift) | (i > 1 ? b[i - 2] >> (LIMB_WIDTH - shift) : 0) : b[i - 1];
+            }
+            u[m] = shift ? a[m - 1] >> (LIMB_WIDTH - shift) : 0;
+            for (size_t i = m; i > 0; i--) {
+                u[i - 1] = shift ? (a[i - 1] << shift) | (i > 1 ? a[i - 2] >> (LIMB_WIDTH - shift) : 0) : a[i - 1];
+            }
+
+            for (size_t j = m - n + 1; j > 0; j--) {
+                limb *const window = u.data() + j - 1;
+                const dlimb top = (dlimb(window[n]) << LIMB_WIDTH) | window[n - 1];
+                dlimb qhat = top / v[n - 1];
+                dlimb rhat = top % v[n - 1];
+                while (qhat >> LIMB_WIDTH || qhat * v[n - 2] > ((rhat << LIMB_WIDTH) | window[n - 2])) {
+                    qhat--;
+                    rhat += v[n - 1];
+                    if (rhat >> LIMB_WIDTH) {
+                        break;
+                    }
+                }
+
+                // window -= qhat * v, estimation is at most one more than real limb of quotient
+                limb carry  = 0;
+                limb borrow = 0;
+                for (size_t i = 0; i < n; i++) {
+                    const dlimb product = qhat * v[i] + carry;
+                    carry = limb(product >> LIMB_WIDTH);
+                    const dlimb difference = dlimb(window[i]) - limb(product) - borrow;
+                    window[i] = limb(difference);
+                    borrow    = limb(difference >> LIMB_WIDTH) & 1;
+                }
+                const dlimb difference = dlimb(window[n]) - carry - borrow;
+                window[n] = limb(difference);
+                q[j - 1]  = limb(qhat);
+
+                if (difference >> LIMB_WIDTH) {
+                    // Estimation was too big, divisor is added back
+                    q[j - 1]--;
+                    limb addCarry = 0;
+                    for (size_t i = 0; i < n; i++) {
+                        const dlimb sum = dlimb(window[i]) + v[i] + addCarry;
+                        window[i] = limb(sum);
+                        addCarry  = limb(sum >> LIMB_WIDTH);
+                    }
+                    window[n] += addCarry;
+                }
+            }
+
+            for (size_t i = 0; i < n; i++) {
+                r[i] = shift ? (u[i] >> shift) | (u[i + 1] << (LIMB_WIDTH - shift)) : u[i];
+            }
+        }
+    };
+
+    template <size_t Bits, bool Signed>
+    FixedInt<Bits, Signed>::FixedInt(const BigInt &numberBI) {
+        const size_t n = std::min(LIMBS, numberBI.numberArr.size());
+        for (size_t i = 0; i < n; i++) {
+            limbs[i] = numberBI.numberArr[i];
+        }
+        if (numberBI.isNegative) {
+            *this = -*this;
+        }
+    }
+
+    template <size_t Bits, bool Signed>
+    FixedInt<Bits, Signed>::operator BigInt() const {
+        // Magnitude of signed minimal number is 2^(Bits - 1), which is its own negation as unsigned number
+        const bool negative = isNegative();
+        const std::array<limb, LIMBS> &magnitude = negative ? (-*this).limbs : limbs;
+        BigInt forRet(std::pmr::get_default_resource());
+        forRet.assignMagnitude(LimbArray(magnitude.data(), magnitude.data() + LIMBS), negative);
+        return forRet;
+    }
+
+    // Common widths
+    typedef FixedInt<128>         Int128;
+    typedef FixedInt<256>         Int256;
+    typedef FixedInt<512>         Int512;
+    typedef FixedInt<128, false>  UInt128;
+    typedef FixedInt<256, false>  UInt256;
+    typedef FixedInt<512, false>  UInt512;
+}
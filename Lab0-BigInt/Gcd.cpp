@@ -0,0 +1,343 @@
+#include "Modular.h"
+#include "Kernels.h"
+
+#ifndef algorithm
+#include <algorithm>
+#endif
+
+#ifndef cstdint
+#include <cstdint>
+#endif
+
+namespace LongMath {
+    // Euclid's algorithm on pair a >= b >= 0, which is changed by unimodular matrices
+    // Any such matrix keeps gcd of pair, so matrix found from high limbs only may be applied too:
+    // if it makes number negative, sign is changed, and pair is sorted again
+    // Steps:
+    // Division step: (a, b) = (b, a - qb), q = a / b
+    // Lehmer's step: quotients of 62 high bits (Knuth's algorithm L) are joined to one matrix,
+    // which is applied to whole numbers, so there is one pass through limbs per about 30 bits
+    // Half gcd: matrix for high half of numbers reduces whole numbers to about 3/4 of their length,
+    // one more such matrix reduces them to half, so gcd costs O(M(n) log n)
+    class Euclid {
+    public:
+        // track = 0: only pair is kept
+        // track = 1: cofactors of first number ua and ub are also kept
+        // track = 2: whole matrix is kept
+        Euclid(const BigInt &x, const BigInt &y, int track);
+
+        BigInt a;
+        BigInt b;
+        // a = ua * x + va * y, b = ub * x + vb * y for numbers x and y given to constructor
+        BigInt ua;
+        BigInt va;
+        BigInt ub;
+        BigInt vb;
+
+        // Reduces pair until b = 0, then a = gcd(x, y)
+        void run();
+
+    private:
+        int track;
+        BigInt q;
+        BigInt t0;
+        BigInt t1;
+        LimbArray product;
+
+        static size_t limbs(const BigInt &x) {
+            return kernels::normalizedSize(x.numberArr.data(), x.numberArr.size());
+        }
+
+        static size_t bitLength(const BigInt &x) {
+            const size_t n = limbs(x);
+            return n ? n * LIMB_WIDTH - __builtin_clzll(x.numberArr[n - 1]) : 0;
+        }
+
+        // Returns 64 bits of magnitude from given bit
+        static limb bitsAt(const BigInt &x, size_t shift) {
+            const size_t i = shift / LIMB_WIDTH;
+            const size_t k = shift % LIMB_WIDTH;
+            const size_t n = limbs(x);
+            const limb low  = i < n ? x.numberArr[i] : 0;
+            const limb high = i + 1 < n ? x.numberArr[i + 1] : 0;
+            return k ? (low >> k) | (high << (LIMB_WIDTH - k)) : low;
+        }
+
+        // (x, y) = (m00 x + m01 y, m10 x + m11 y)
+        void transform(BigInt &x, BigInt &y,
+                       const BigInt &m00, const BigInt &m01, const BigInt &m10, const BigInt &m11);
+        // Same for matrix of single limbs
+        void transform(BigInt &x, BigInt &y, std::int64_t m00, std::int64_t m01, std::int64_t m10, std::int64_t m11);
+        // r += x * y
+        void addmulSmall(BigInt &r, const BigInt &x, std::int64_t y);
+        // Applies matrix to pair (if values is true) and to kept cofactors, then makes pair positive and sorted
+        void apply(const BigInt &m00, const BigInt &m01, const BigInt &m10, const BigInt &m11, bool values = true);
+        void normalize();
+
+        // r = x a + y b for Lehmer's matrix row, b must have same number of limbs as a
+        void combine(BigInt &r, std::int64_t x, std::int64_t y) const;
+
+        void divisionStep();
+        void lehmerStep();
+        // Reduces pair to about half of its limbs (b has at most n / 2 + 1 limbs)
+        void halfGcd();
+        // Applies matrix of half gcd for numbers without k low limbs
+        void reduceByHigh(size_t k);
+    };
+
+    Euclid::Euclid(const BigInt &x, const BigInt &y, int track) :
+            a(x), b(y), ua(ONE), va(ZERO), ub(ZERO), vb(ONE), track(track) {
+        // Signs of numbers go to cofactors here
+        normalize();
+    }
+
+    void Euclid::transform(BigInt &x, BigInt &y,
+                           const BigInt &m00, const BigInt &m01, const BigInt &m10, const BigInt &m11) {
+        mul(t0, m00, x);
+        addmul(t0, m01, y);
+        mul(t1, m10, x);
+        addmul(t1, m11, y);
+        std::swap(x, t0);
+        std::swap(y, t1);
+    }
+
+    void Euclid::apply(const BigInt &m00, const BigInt &m01, const BigInt &m10, const BigInt &m11, bool values) {
+        if (values) {
+            transform(a, b, m00, m01, m10, m11);
+        }
+        if (track >= 1) {
+            transform(ua, ub, m00, m01, m10, m11);
+        }
+        if (track >= 2) {
+            transform(va, vb, m00, m01, m10, m11);
+        }
+        normalize();
+    }
+
+    void Euclid::normalize() {
+        if (a.isNegative) {
+            a.negate();
+            ua.negate();
+            va.negate();
+        }
+        if (b.isNegative) {
+            b.negate();
+            ub.negate();
+            vb.negate();
+        }
+        if (a < b) {
+            std::swap(a,  b);
+            std::swap(ua, ub);
+            std::swap(va, vb);
+        }
+    }
+
+    void Euclid::divisionStep() {
+        divmod(q, t0, a, b);
+        std::swap(a, b);
+        std::swap(b, t0);
+        if (track >= 1) {
+            // (ua, ub) = (ub, ua - q ub)
+            mul(t0, q, ub);
+            sub(t0, ua, t0);
+            std::swap(ua, ub);
+            std::swap(ub, t0);
+        }
+        if (track >= 2) {
+            mul(t0, q, vb);
+            sub(t0, va, t0);
+            std::swap(va, vb);
+            std::swap(vb, t0);
+        }
+    }
+
+    void Euclid::lehmerStep() {
+        // x and y are high bits of a and b from same position, x < 2^62,
+        // quotient is taken only if it is same for bounds of a / b (x + A) / (y + C) and (x + B) / (y + D)
+        const size_t bits  = bitLength(a);
+        const size_t shift = bits > 62 ? bits - 62 : 0;
+        std::int64_t x = std::int64_t(bitsAt(a, shift));
+        std::int64_t y = std::int64_t(bitsAt(b, shift));
+        std::int64_t A = 1;
+        std::int64_t B = 0;
+        std::int64_t C = 0;
+        std::int64_t D = 1;
+        while (y + C != 0 && y + D != 0) {
+            const std::int64_t quotient = (x + A) / (y + C);
+            if (quotient != (x + B) / (y + D)) {
+                break;
+            }
+            std::int64_t t = A - quotient * C;
+            A = C;
+            C = t;
+            t = B - quotient * D;
+            B = D;
+            D = t;
+            t = x - quotient * y;
+            x = y;
+            y = t;
+        }
+
+        // High bits gave no quotient, so whole one is needed
+        if (!B) {
+            divisionStep();
+            return;
+        }
+
+        // Quotients are right for whole numbers, so new pair is positive and
+        // is found by multiplications by single limbs: in every row one coefficient is negative
+        const size_t n = limbs(a);
+        b.numberArr.resize(n);
+        combine(t0, A, B);
+        combine(t1, C, D);
+        std::swap(a, t0);
+        std::swap(b, t1);
+        if (track >= 1) {
+            transform(ua, ub, A, B, C, D);
+        }
+        if (track >= 2) {
+            transform(va, vb, A, B, C, D);
+        }
+    }
+
+    void Euclid::addmulSmall(BigInt &r, const BigInt &x, std::int64_t y) {
+        const size_t n = x.numberArr.size();
+        product.resize(n + 1);
+        product[n] = kernels::mul_1(product.data(), x.numberArr.data(), n, y < 0 ? 0 - limb(y) : limb(y));
+        r.addSigned(product.data(), n + 1, x.isNegative != (y < 0));
+    }
+
+    void Euclid::transform(BigInt &x, BigInt &y, std::int64_t m00, std::int64_t m01, std::int64_t m10, std::int64_t m11) {
+        t0.numberArr.clear();
+        t0.fixMagnitude(false);
+        t1.numberArr.clear();
+        t1.fixMagnitude(false);
+        addmulSmall(t0, x, m00);
+        addmulSmall(t0, y, m01);
+        addmulSmall(t1, x, m10);
+        addmulSmall(t1, y, m11);
+        std::swap(x, t0);
+        std::swap(y, t1);
+    }
+
+    void Euclid::combine(BigInt &r, std::int64_t x, std::int64_t y) const {
+        // r = x a + y b, where a and b have n limbs, x and y have different signs (or one of them is zero)
+        const size_t n = a.numberArr.size();
+        const bool first = y <= 0;
+        const limb *const plus  = first ? a.numberArr.data() : b.numberArr.data();
+        const limb *const minus = first ? b.numberArr.data() : a.numberArr.data();
+        const limb plusFactor  = first ? limb(x) : limb(y);
+        const limb minusFactor = first ? 0 - limb(y) : 0 - limb(x);
+
+        r.numberArr.resize(n + 1);
+        limb *const p = r.numberArr.data();
+        p[n]  = kernels::mul_1(p, plus, n, plusFactor);
+        p[n] -= kernels::submul_1(p, minus, n, minusFactor);
+        r.fixMagnitude(false);
+    }
+
+    void Euclid::reduceByHigh(size_t k) {
+        Euclid high(a >> (k * LIMB_WIDTH), b >> (k * LIMB_WIDTH), 2);
+        high.halfGcd();
+        apply(high.ua, high.va, high.ub, high.vb);
+    }
+
+    void Euclid::halfGcd() {
+        const size_t n      = limbs(a);
+        const size_t target = n / 2 + 1;
+
+        if (n >= HGCD_THRESHOLD) {
+            // Matrix of high half has about n / 4 limbs and reduces pair to about 3n / 4 limbs
+            reduceByHigh(n / 2);
+            if (b != ZERO && limbs(b) > target) {
+                divisionStep();
+            }
+            // Second high part has twice as many limbs as are left to reduce
+            const size_t m = limbs(a);
+            if (b != ZERO && limbs(b) > target && 2 * m > n + 2) {
+                reduceByHigh(n - m);
+            }
+        }
+
+        // Rest of reduction (or all of it for short numbers) is done by Lehmer's steps
+        while (b != ZERO && limbs(b) > target) {
+            lehmerStep();
+        }
+    }
+
+    void Euclid::run() {
+        while (b != ZERO) {
+            const size_t n = limbs(a);
+            if (limbs(b) + 1 < n) {
+                // Numbers of different lengths are made close by one division
+                divisionStep();
+            } else if (n >= GCD_DC_THRESHOLD && limbs(b) > n / 2 + 1) {
+                // Half gcd makes b shorter than n / 2 + 1 limbs, so it always gives progress
+                Euclid half(a, b, 2);
+                half.halfGcd();
+                std::swap(a, half.a);
+                std::swap(b, half.b);
+                apply(half.ua, half.va, half.ub, half.vb, false);
+            } else {
+                lehmerStep();
+            }
+        }
+    }
+
+    //
+    // Public functions
+    //
+
+    BigInt gcd(const BigInt &a, const BigInt &b) {
+        Euclid euclid(a, b, 0);
+        euclid.run();
+        return euclid.a;
+    }
+
+    BigInt lcm(const BigInt &a, const BigInt &b) {
+        if (a == ZERO || b == ZERO) {
+            return ZERO;
+        }
+        BigInt forRet(a / gcd(a, b) * b);
+        return forRet < ZERO ? -std::move(forRet) : forRet;
+    }
+
+    std::tuple<BigInt, BigInt, BigInt> xgcd(const BigInt &a, const BigInt &b) {
+        Euclid euclid(a, b, 1);
+        euclid.run();
+        BigInt g(std::move(euclid.a));
+        BigInt s(std::move(euclid.ua));
+        if (g == ZERO) {
+            return {ZERO, ZERO, ZERO};
+        }
+        if (b == ZERO) {
+            return {g, s, ZERO};
+        }
+
+        // Cofactors are defined up to multiple of (b / g, -a / g), the least one is taken
+        const BigInt period = (b < ZERO ? -b : b) / g;
+        s %= period;
+        if (s < ZERO) {
+            s += period;
+        }
+        if (s + s > period) {
+            s -= period;
+        }
+        BigInt t((g - s * a) / b);
+        return {g, s, t};
+    }
+
+    BigInt modinv(const BigInt &a, const BigInt &m) {
+        if (m == ZERO) {
+            throw std::invalid_argument("division by zero");
+        }
+        auto [g, s, t] = xgcd(a, m);
+        if (g != ONE) {
+            throw std::invalid_argument("number is not invertible");
+        }
+        if (s < ZERO) {
+            s += m < ZERO ? -m : m;
+        }
+        return s;
+    }
+}
@@ -0,0 +1,131 @@
+#include "Kernels.h"
+
+#ifndef algorithm
+#include <algorithm>
+#endif
+
+namespace LongMath::kernels {
+    size_t normalizedSize(const limb *a, size_t n) {
+        while (n > 0 && !a[n - 1]) {
+            n--;
+        }
+        return n;
+    }
+
+    limb add(limb *r, const limb *a, size_t an, const limb *b, size_t bn) {
+        limb carry = add_n(r, a, b, bn);
+        size_t i = bn;
+        for (; i < an && carry; i++) {
+            r[i]  = a[i] + 1;
+            carry = !r[i];
+        }
+        // Rest of a is copied only if result is written to another array
+        if (r != a) {
+            std::copy(a + i, a + an, r + i);
+        }
+        return carry;
+    }
+
+    limb sub(limb *r, const limb *a, size_t an, const limb *b, size_t bn) {
+        limb borrow = sub_n(r, a, b, bn);
+        size_t i = bn;
+        for (; i < an && borrow; i++) {
+            borrow = !a[i];
+            r[i]   = a[i] - 1;
+        }
+        if (r != a) {
+            std::copy(a + i, a + an, r + i);
+        }
+        return borrow;
+    }
+
+    // Every result limb is funnel shift of two neighbour limbs, so loops have no branches
+    // and compiler vectorizes them
+    limb lshift(limb *r, const limb *a, size_t n, unsigned shift) {
+        if (!n) {
+            return 0;
+        }
+        const unsigned back = LIMB_WIDTH - shift;
+        const limb out = a[n - 1] >> back;
+        for (size_t i = n - 1; i > 0; i--) {
+            r[i] = (a[i] << shift) | (a[i - 1] >> back);
+        }
+        r[0] = a[0] << shift;
+        return out;
+    }
+
+    limb rshift(limb *r, const limb *a, size_t n, unsigned shift) {
+        if (!n) {
+            return 0;
+        }
+        const unsigned back = LIMB_WIDTH - shift;
+        const limb out = a[0] << back;
+        for (size_t i = 0; i + 1 < n; i++) {
+            r[i] = (a[i] >> shift) | (a[i + 1] << back);
+        }
+        r[n - 1] = a[n - 1] >> shift;
+        return out;
+    }
+
+    limb divrem_1(limb *q, const limb *a, size_t n, limb d) {
+        dlimb remainder = 0;
+        for (size_t i = n; i > 0; i--) {
+            remainder = (remainder << LIMB_WIDTH) | a[i - 1];
+            q[i - 1]  = limb(remainder / d);
+            remainder %= d;
+        }
+        return limb(remainder);
+    }
+
+    limb mod_base_m1(const limb *a, size_t n) {
+        // Carries out of high limb are worth 1 each, they are added back at the end
+        limb sum   = 0;
+        limb carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            sum   += a[i];
+            carry += sum < a[i];
+        }
+        sum += carry;
+        sum += sum < carry;
+        return sum == ~limb(0) ? 0 : sum;
+    }
+
+    void mul_basecase(limb *r, const limb *a, size_t an, const limb *b, size_t bn) {
+        for (size_t i = 0; i < an + bn; i++) {
+            r[i] = 0;
+        }
+        for (size_t i = 0; i < bn; i++) {
+            r[i + an] = addmul_1(r + i, a, an, b[i]);
+        }
+    }
+
+    void sqr_basecase(limb *r, const limb *a, size_t n) {
+        if (!n) {
+            return;
+        }
+        // Products a[i] * a[j] with i < j are found once and doubled
+        // Row i writes its carry to r[i + n], which no row has touched before, so only ends need zeros
+        r[0]         = 0;
+        r[n]         = mul_1(r + 1, a + 1, n - 1, a[0]);
+        r[2 * n - 1] = 0;
+        for (size_t i = 1; i + 1 < n; i++) {
+            r[i + n] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+        }
+
+        // Then doubling and squares a[i]^2, which are added to limbs 2i and 2i + 1, are done in one pass
+        limb bit   = 0;
+        limb carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            const limb low      = r[2 * i];
+            const limb high     = r[2 * i + 1];
+            const dlimb square  = dlimb(a[i]) * a[i];
+            const dlimb sumLow  = dlimb((low << 1) | bit) + limb(square) + carry;
+            const dlimb sumHigh = dlimb((high << 1) | (low >> (LIMB_WIDTH - 1))) + limb(square >> LIMB_WIDTH)
+                                  + limb(sumLow >> LIMB_WIDTH);
+            r[2 * i]     = limb(sumLow);
+            r[2 * i + 1] = limb(sumHigh);
+            bit          = high >> (LIMB_WIDTH - 1);
+            carry        = limb(sumHigh >> LIMB_WIDTH);
+        }
+    }
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "BigInt.h"
+
+#ifndef functional
+#include <functional>
+#endif
+
+// Kernels are low level functions, which work with magnitudes stored in limb arrays
+// Arrays are passed as pointer and length, lower limb goes first, there is no sign
+// Result array may be same as argument array where it is said
+namespace LongMath::kernels
+{
+    // Kernels cmp, add_n, sub_n, and_n, ior_n, xor_n, mul_1, addmul_1 and submul_1 use AVX2, AVX-512,
+    // or MULX and ADX on processors, which have them (see SIMD_KERNELS)
+
+    // Compares a and b with same length n
+    // Returns -1 if a < b, 0 if a == b and 1 if a > b
+    int cmp(const limb *a, const limb *b, size_t n);
+
+    // Returns length of a without lead zero limbs
+    size_t normalizedSize(const limb *a, size_t n);
+
+    // r = a + b, all arrays have length n, returns carry
+    // r may be same as a or b
+    limb add_n(limb *r, const limb *a, const limb *b, size_t n);
+
+    // r = a - b, all arrays have length n, returns borrow
+    // r may be same as a or b
+    limb sub_n(limb *r, const limb *a, const limb *b, size_t n);
+
+    // Masks of bitwise kernels: every limb of a, b and result is xor-ed with its mask (0 or LIMB_MAX),
+    // so numbers in two's complement are complemented without separate pass
+    struct Complements {
+        limb a = 0;
+        limb b = 0;
+        limb r = 0;
+    };
+
+    // r = a & b, r = a | b and r = a ^ b with complements, all arrays have length n
+    // r may be same as a or b
+    void and_n(limb *r, const limb *a, const limb *b, size_t n, Complements masks = {});
+    void ior_n(limb *r, const limb *a, const limb *b, size_t n, Complements masks = {});
+    void xor_n(limb *r, const limb *a, const limb *b, size_t n, Complements masks = {});
+
+    // r = a + b, an >= bn, r has length an, returns carry
+    // r may be same as a or b
+    limb add(limb *r, const limb *a, size_t an, const limb *b, size_t bn);
+
+    // r = a - b, an >= bn, r has length an, returns borrow
+    // r may be same as a or b
+    limb sub(limb *r, const limb *a, size_t an, const limb *b, size_t bn);
+
+    // r = a * b, a and r have length n, returns high limb of product
+    // r may be same as a
+    limb mul_1(limb *r, const limb *a, size_t n, limb b);
+
+    // r += a * b, a and r have length n, returns carry
+    limb addmul_1(limb *r, const limb *a, size_t n, limb b);
+
+    // r -= a * b, a and r have length n, returns borrow
+    limb submul_1(limb *r, const limb *a, size_t n, limb b);
+
+    // r = a << shift, 0 < shift < LIMB_WIDTH, returns bits shifted out from high limb
+    // r may be same as a or overlap it from higher address, limbs are written from high to low
+    limb lshift(limb *r, const limb *a, size_t n, unsigned shift);
+
+    // r = a >> shift, 0 < shift < LIMB_WIDTH, returns bits shifted out from low limb
+    // (in high bits of returned limb), r may be same as a or overlap it from lower address,
+    // limbs are written from low to high
+    limb rshift(limb *r, const limb *a, size_t n, unsigned shift);
+
+    // q = a / d, q and a have length n, returns remainder
+    // q may be same as a, d must not be zero
+    limb divrem_1(limb *q, const limb *a, size_t n, limb d);
+
+    // Returns a mod (2^64 - 1), which is found by sum of limbs, because 2^64 = 1 mod (2^64 - 1)
+    // Remainders by all divisors of 2^64 - 1 (3, 5, 17, 257, 641, 65537, 6700417) are taken from it
+    limb mod_base_m1(const limb *a, size_t n);
+
+    // Default strikingly multiplication r = a * b
+    // r has length an + bn and must not overlap a or b
+    void mul_basecase(limb *r, const limb *a, size_t an, const limb *b, size_t bn);
+
+    // Default strikingly squaring r = a * a, which takes about half of multiplications
+    // r has length 2n and must not overlap a
+    void sqr_basecase(limb *r, const limb *a, size_t n);
+
+    // r = a * b, r has length an + bn and must not overlap a or b
+    // Chooses default strikingly multiplication, Karatsuba, Toom-3 or number theoretic transform
+    // by KARATSUBA_THRESHOLD, TOOM3_THRESHOLD and NTT_THRESHOLD,
+    // temporary limbs are allocated once per call (and once per part, which runs in other thread)
+    // Parts of long multiplication run in parallel, when threads > 1 (see PARALLEL_MUL_THRESHOLD)
+    void mul(limb *r, const limb *a, size_t an, const limb *b, size_t bn, size_t threads = MUL_THREADS);
+
+    // Same as mul in one thread with temporary limbs from scratch, which has mul_scratch_size(an, bn) limbs,
+    // so repeated products of same lengths allocate nothing (except NTT, which keeps its own arrays)
+    size_t mul_scratch_size(size_t an, size_t bn);
+    void mul_scratch(limb *r, const limb *a, size_t an, const limb *b, size_t bn, limb *scratch);
+
+    // r = a * b by number theoretic transform modulo three primes, r has length an + bn
+    // Used by mul when both arguments have at least NTT_THRESHOLD limbs
+    // Residues of primes and halves of transforms are found in parallel, when threads > 1
+    void mul_ntt(limb *r, const limb *a, size_t an, const limb *b, size_t bn, size_t threads = 1);
+
+    // Calls task(i, share) for i from 0 to count - 1 and returns, when all calls are done
+    // Calls run in threads of one pool (calling thread takes part), share is number of threads
+    // given to call: threads are divided between calls, every call gets at least one
+    // Pool is started on first use and grows up to threads - 1 workers, threads <= 1 runs calls one by one
+    // Task may call parallel itself, first exception of tasks is thrown after all of them are done
+    void parallel(size_t threads, size_t count, const std::function<void(size_t, size_t)> &task);
+
+    // q = u / v (un - vn + 1 limbs), r = u % v (vn limbs)
+    // Requires un >= vn >= 1 and v[vn - 1] != 0, q and r must not overlap arguments
+    // Uses Knuth's algorithm D (The Art of Computer Programming, vol. 2, 4.3.1)
+    // or Barrett's reduction when divisor and quotient have at least BARRETT_THRESHOLD limbs
+    void divrem(limb *q, limb *r, const limb *u, size_t un, const limb *v, size_t vn);
+
+    // Reciprocal of normalized d (lead bit is set) with length n:
+    // inv = (B^2n - 1) / d, inv has length n + 1
+    // Uses Newton's iteration, which doubles precision on every step
+    void invert(limb *inv, const limb *d, size_t n);
+
+    // Barrett's division by normalized d with length n and its reciprocal inv (see invert)
+    // q = u / d (un - n + 1 limbs), r = u % d (n limbs), un >= n
+    // Costs about two multiplications of length n per n limbs of quotient
+    void divrem_preinv(limb *q, limb *r, const limb *u, size_t un,
+                       const limb *d, size_t n, const limb *inv);
+
+    // Returns -1 / m0 mod B for odd m0, where B = 2^64
+    limb mont_inverse(limb m0);
+
+    // Montgomery's reduction modulo odd m with length n: r = t / B^n mod m
+    // t has 2n limbs, t < m * B^n, inv = mont_inverse(m[0]), t is changed
+    void redc(limb *r, limb *t, const limb *m, size_t n, limb inv);
+
+    // Montgomery's multiplication: r = a * b / B^n mod m, a, b < m have length n
+    // t is temporary array with mont_scratch_size(n) limbs, r may be same as a or b
+    // Short modulus (less than KARATSUBA_THRESHOLD limbs) multiplies and reduces in one pass
+    // (coarsely integrated operand scanning), longer one uses fast multiplication and redc
+    void mont_mul(limb *r, const limb *a, const limb *b, const limb *m, size_t n, limb inv, limb *t);
+
+    // Montgomery's squaring: r = a * a / B^n mod m, takes t and r as mont_mul
+    // Square is found by sqr_basecase (or Karatsuba's square, see KARATSUBA_SQR_THRESHOLD),
+    // which takes about half of products
+    void mont_sqr(limb *r, const limb *a, const limb *m, size_t n, limb inv, limb *t);
+
+    // Returns number of limbs of temporary array for mont_mul and mont_sqr with modulus length n
+    size_t mont_scratch_size(size_t n);
+
+    // Conversions to and from system with base from 2 to 36, digits are 0-9 and a-z
+
+    // Returns number of digits, which is enough for a with length n
+    // It is exact for base 2^k and may be 2 more than real number of digits for other bases
+    size_t radix_size(const limb *a, size_t n, unsigned base);
+
+    // Writes exactly width digits of a with length n to s (lead zeros included), a < base^width
+    // Base 2^k takes one pass through limbs, other bases use division by cached powers of base
+    // from RADIX_CONVERSION_THRESHOLD limbs
+    void to_radix(char *s, size_t width, const limb *a, size_t n, unsigned base);
+
+    // Returns number of limbs, which is enough for number with given number of digits
+    size_t radix_limbs(size_t digits, unsigned base);
+
+    // Writes number from s with length digits to r, returns its length without lead zero limbs
+    // r must have radix_limbs(length, base) limbs, s must consist only of digits of base (it is not checked),
+    // capital letters are same as small ones
+    // Base 2^k takes one pass through digits, other bases use multiplication by cached powers of base
+    // from RADIX_CONVERSION_THRESHOLD limbs
+    size_t from_radix(limb *r, const char *s, size_t length, unsigned base);
+
+    // Reads number, which digits come by parts (as from stream), with same cost as from_radix for whole string
+    // Digits are converted by blocks of chunkDigits * 2^6 digits, and two parts with same number of digits
+    // are joined by multiplication by cached power of base, as halves in from_radix,
+    // so only limbs of number and one block of digits are kept
+    class RadixReader {
+    public:
+        explicit RadixReader(unsigned base);
+
+        // Adds digits after digits, which are read already, s must consist only of digits of base
+        void append(const char *s, size_t length);
+
+        // Returns number from all digits without lead zero limbs (zero is empty), reader becomes empty
+        std::vector<limb> finish();
+
+    private:
+        struct Part {
+            std::vector<limb> value;    // Without lead zero limbs
+            size_t digits;
+        };
+
+        // Converts blockDigits digits from s and joins them with parts of same length
+        void push(const char *s);
+
+        unsigned base;
+        size_t blockDigits;
+        std::string block;          // Digits, which are not converted yet, there are less than blockDigits of them
+        std::vector<Part> parts;    // Converted digits, older parts are higher and longer
+    };
+}
@@ -0,0 +1,119 @@
+#include "LimbArray.h"
+
+#ifndef algorithm
+#include <algorithm>
+#endif
+
+namespace LongMath {
+    // Realisation of private methods
+    void LimbArray::grow(size_t n) {
+        // Capacity is doubled at least, so push_back costs O(1) in average
+        const size_t newCapacity = std::max(n, 2 * capacityValue);
+        limb *const newArray = static_cast<limb *>(memory->allocate(newCapacity * sizeof(limb), alignof(limb)));
+        std::copy(array, array + length, newArray);
+        release();
+        array         = newArray;
+        capacityValue = newCapacity;
+    }
+
+    void LimbArray::release() {
+        if (!isInline()) {
+            memory->deallocate(array, capacityValue * sizeof(limb), alignof(limb));
+        }
+        array         = inlineBuffer;
+        capacityValue = INLINE_CAPACITY;
+    }
+
+    //
+    // Realisation of public members
+    //
+
+    // Constructors
+    LimbArray::LimbArray(std::pmr::memory_resource *resource) :
+            memory(resource) {}
+
+    LimbArray::LimbArray(size_t n, limb value) {
+        resize(n, value);
+    }
+
+    LimbArray::LimbArray(const limb *first, const limb *last) {
+        reserve(last - first);
+        std::copy(first, last, array);
+        length = last - first;
+    }
+
+    LimbArray::LimbArray(std::initializer_list<limb> limbs) :
+            LimbArray(limbs.begin(), limbs.end()) {}
+
+    LimbArray::LimbArray(const LimbArray &other) :
+            memory(other.memory) {
+        *this = other;
+    }
+
+    // Array with same resource never copies limbs to heap on move assignment
+    LimbArray::LimbArray(LimbArray &&other) noexcept :
+            memory(other.memory) {
+        *this = std::move(other);
+    }
+
+    LimbArray::~LimbArray() {
+        release();
+    }
+
+    // Assignments
+    LimbArray &LimbArray::operator=(const LimbArray &other) {
+        if (this != &other) {
+            length = 0;
+            reserve(other.length);
+            std::copy(other.begin(), other.end(), array);
+            length = other.length;
+        }
+        return *this;
+    }
+
+    LimbArray &LimbArray::operator=(LimbArray &&other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (other.isInline()) {
+            // Inline buffer always fits in own memory
+            std::copy(other.begin(), other.end(), array);
+        } else if (*memory != *other.memory) {
+            // Memory of other resource can not be freed by own one
+            *this = static_cast<const LimbArray &>(other);
+        } else {
+            release();
+            array         = other.array;
+            capacityValue = other.capacityValue;
+            other.array         = other.inlineBuffer;
+            other.capacityValue = INLINE_CAPACITY;
+        }
+        length       = other.length;
+        other.length = 0;
+        return *this;
+    }
+
+    // Modifiers
+    void LimbArray::resize(size_t n, limb value) {
+        reserve(n);
+        if (n > length) {
+            std::fill(array + length, array + n, value);
+        }
+        length = n;
+    }
+
+    void LimbArray::reserve(size_t n) {
+        if (n > capacityValue) {
+            grow(n);
+        }
+    }
+
+    // Compare operators
+    bool LimbArray::operator==(const LimbArray &other) const {
+        return length == other.length && std::equal(begin(), end(), other.begin());
+    }
+
+    bool LimbArray::operator!=(const LimbArray &other) const {
+        return !(*this == other);
+    }
+}
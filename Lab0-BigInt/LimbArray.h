@@ -0,0 +1,123 @@
+#pragma once
+
+#ifndef cstddef
+#include <cstddef>
+#endif
+
+#ifndef cstdint
+#include <cstdint>
+#endif
+
+#ifndef initializer_list
+#include <initializer_list>
+#endif
+
+#ifndef memory_resource
+#include <memory_resource>
+#endif
+
+namespace LongMath
+{
+    // In this realisation the basic type of BigInt is 64-bit unsigned limb,
+    // which is easier to typedef for shorter name
+    typedef std::uint64_t limb;
+    // Double-width type, keeps carry of addition and high half of multiplication
+    typedef unsigned __int128 dlimb;
+
+    const size_t LIMB_WIDTH = 64;
+    const limb   LIMB_MAX   = UINT64_MAX;
+
+    // Array of limbs with small buffer inside the object
+    // Numbers up to INLINE_CAPACITY limbs are stored without heap allocation,
+    // array moves to heap only when it grows past the buffer
+    // Interface is a part of std::vector's one, which is used by BigInt
+    // Heap memory is taken from std::pmr::memory_resource, default one is used if other is not given
+    // Copy keeps resource of original array, assignment keeps own resource
+    class LimbArray {
+    public:
+        static constexpr size_t INLINE_CAPACITY = 2;
+
+        // Constructors
+
+        // Default constructor makes empty array in inline buffer
+        LimbArray() = default;
+        // Makes empty array, which takes memory from resource
+        explicit LimbArray(std::pmr::memory_resource *resource);
+        // Makes array with n copies of value
+        explicit LimbArray(size_t n, limb value = 0);
+        // Copies limbs from [first, last)
+        LimbArray(const limb *first, const limb *last);
+        LimbArray(std::initializer_list<limb>);
+        // Copy constructor allocates only if other array does not fit in inline buffer
+        LimbArray(const LimbArray&);
+        // Move constructor takes heap array with its resource or copies inline buffer
+        LimbArray(LimbArray&&) noexcept;
+
+        ~LimbArray();
+
+        LimbArray &operator=(const LimbArray&);
+        // Heap array is taken only if both arrays use equal resources, otherwise limbs are copied
+        LimbArray &operator=(      LimbArray&&);
+
+        [[nodiscard]] std::pmr::memory_resource *resource() const { return memory; }
+
+        // Element access
+        limb       &operator[](size_t i)       { return array[i]; }
+        const limb &operator[](size_t i) const { return array[i]; }
+        limb       &back()       { return array[length - 1]; }
+        const limb &back() const { return array[length - 1]; }
+        limb       *data()       { return array; }
+        const limb *data() const { return array; }
+
+        limb       *begin()       { return array; }
+        const limb *begin() const { return array; }
+        limb       *end()         { return array + length; }
+        const limb *end()   const { return array + length; }
+
+        [[nodiscard]] size_t size()     const { return length; }
+        [[nodiscard]] size_t capacity() const { return capacityValue; }
+        [[nodiscard]] bool   empty()    const { return !length; }
+
+        // Modifiers
+        void push_back(limb value) {
+            if (length == capacityValue) {
+                grow(length + 1);
+            }
+            array[length++] = value;
+        }
+
+        void pop_back() {
+            length--;
+        }
+
+        void clear() {
+            length = 0;
+        }
+
+        // New limbs get value, array keeps its memory when it becomes shorter
+        void resize(size_t n, limb value = 0);
+
+        // Makes capacity at least n without changing of limbs
+        void reserve(size_t n);
+
+        // Compares lengths and limbs
+        bool operator==(const LimbArray &) const;
+        bool operator!=(const LimbArray &) const;
+
+    private:
+        limb  *array         = inlineBuffer;    // Points to inlineBuffer or to heap array
+        size_t length        = 0;
+        size_t capacityValue = INLINE_CAPACITY;
+        limb   inlineBuffer[INLINE_CAPACITY] = {};
+        std::pmr::memory_resource *memory    = std::pmr::get_default_resource();
+
+        [[nodiscard]] bool isInline() const {
+            return array == inlineBuffer;
+        }
+
+        // Moves limbs to heap array with capacity at least n
+        void grow(size_t n);
+        // Frees heap array (if there is one) and returns to inline buffer
+        void release();
+    };
+}
@@ -0,0 +1,292 @@
+#include "Modular.h"
+#include "Kernels.h"
+
+#ifndef algorithm
+#include <algorithm>
+#endif
+
+namespace LongMath {
+    namespace {
+        // Returns number of bits of a with length n without lead zero bits
+        size_t bitLength(const limb *a, size_t n) {
+            n = kernels::normalizedSize(a, n);
+            return n ? n * LIMB_WIDTH - __builtin_clzll(a[n - 1]) : 0;
+        }
+
+        bool bit(const limb *a, size_t i) {
+            return (a[i / LIMB_WIDTH] >> (i % LIMB_WIDTH)) & 1;
+        }
+
+        // Wider window takes less multiplications, but table of 2^(window - 1) odd powers costs more
+        size_t windowSize(size_t bits) {
+            const size_t limits[] = {8, 24, 80, 240, 672};
+            size_t forRet = 1;
+            for (size_t limit: limits) {
+                if (bits <= limit) {
+                    break;
+                }
+                forRet++;
+            }
+            return forRet;
+        }
+
+        // Temporary limbs of Montgomery's kernels (see kernels::mont_scratch_size), they are allocated
+        // once per thread and kept between calls, so exponentiation does not allocate in its loop
+        limb *montgomeryScratch(size_t n) {
+            thread_local std::vector<limb> buffer;
+            buffer.resize(std::max(buffer.size(), kernels::mont_scratch_size(n)));
+            return buffer.data();
+        }
+
+        // Temporary limbs of Barrett's reduction, they are kept between calls like montgomeryScratch
+        std::vector<limb> &reducerScratch(size_t i) {
+            thread_local std::vector<limb> buffers[2];
+            return buffers[i];
+        }
+    }
+
+    // Realisation of private methods
+    void Montgomery::reduce(limb *r, const BigInt &a) const {
+        const size_t length = kernels::normalizedSize(a.numberArr.data(), a.numberArr.size());
+        if (a.isNegative || length > n || (length == n && kernels::cmp(a.numberArr.data(), mod.numberArr.data(), n) >= 0)) {
+            BigInt rest(a % mod);
+            if (rest.isNegative) {
+                rest += mod;
+            }
+            reduce(r, rest);
+            return;
+        }
+        std::copy(a.numberArr.data(), a.numberArr.data() + length, r);
+        std::fill(r + length, r + n, 0);
+    }
+
+    BigInt Montgomery::fromLimbs(const limb *a) const {
+        BigInt forRet(mod.resource());
+        forRet.numberArr = LimbArray(a, a + n);
+        forRet.fixMagnitude(false);
+        return forRet;
+    }
+
+    //
+    // Realisation of public members
+    //
+
+    Montgomery::Montgomery(const BigInt &modulus) :
+            mod(modulus) {
+        if (mod <= ZERO || !(mod.numberArr[0] & 1)) {
+            throw std::invalid_argument("Montgomery's modulus must be positive and odd");
+        }
+        n   = kernels::normalizedSize(mod.numberArr.data(), mod.numberArr.size());
+        inv = kernels::mont_inverse(mod.numberArr[0]);
+
+        one.resize(n);
+        square.resize(n);
+        reduce(one.data(),    ONE << (n * LIMB_WIDTH));
+        reduce(square.data(), ONE << (2 * n * LIMB_WIDTH));
+    }
+
+    BigInt Montgomery::toForm(const BigInt &a) const {
+        std::vector<limb> x(n);
+        reduce(x.data(), a);
+        kernels::mont_mul(x.data(), x.data(), square.data(), mod.numberArr.data(), n, inv, montgomeryScratch(n));
+        return fromLimbs(x.data());
+    }
+
+    BigInt Montgomery::fromForm(const BigInt &a) const {
+        std::vector<limb> x(n);
+        limb *const t = montgomeryScratch(n);
+        reduce(t, a);
+        std::fill(t + n, t + 2 * n, 0);
+        kernels::redc(x.data(), t, mod.numberArr.data(), n, inv);
+        return fromLimbs(x.data());
+    }
+
+    BigInt Montgomery::multiply(const BigInt &a, const BigInt &b) const {
+        std::vector<limb> x(n);
+        std::vector<limb> y(n);
+        reduce(x.data(), a);
+        reduce(y.data(), b);
+        kernels::mont_mul(x.data(), x.data(), y.data(), mod.numberArr.data(), n, inv, montgomeryScratch(n));
+        return fromLimbs(x.data());
+    }
+
+    BigInt Montgomery::pow(const BigInt &base, const BigInt &exponent) const {
+        if (exponent.isNegative) {
+            throw std::invalid_argument("negative exponent");
+        }
+        const limb *const m = mod.numberArr.data();
+        const limb *const e = exponent.numberArr.data();
+        const size_t bits = bitLength(e, exponent.numberArr.size());
+        limb *const t = montgomeryScratch(n);
+        std::vector<limb> result(one);
+
+        if (bits) {
+            // table[k] = base^(2k + 1) in Montgomery's form
+            const size_t window = windowSize(bits);
+            std::vector<limb> table(n << (window - 1));
+            std::vector<limb> x2(n);
+            reduce(x2.data(), base);
+            kernels::mont_mul(table.data(), x2.data(), square.data(), m, n, inv, t);
+            kernels::mont_sqr(x2.data(), table.data(), m, n, inv, t);
+            for (size_t k = 1; k < (size_t(1) << (window - 1)); k++) {
+                kernels::mont_mul(&table[k * n], &table[(k - 1) * n], x2.data(), m, n, inv, t);
+            }
+
+            // Bits above i are done, lead bit is set, so first window only takes power from table
+            bool first = true;
+            for (size_t i = bits; i > 0;) {
+                if (!bit(e, i - 1)) {
+                    kernels::mont_sqr(result.data(), result.data(), m, n, inv, t);
+                    i--;
+                    continue;
+                }
+
+                // Window from bit i - 1 to the lowest set bit in it, so its value is odd
+                size_t j = i > window ? i - window : 0;
+                while (!bit(e, j)) {
+                    j++;
+                }
+                size_t value = 0;
+                for (size_t k = i; k > j; k--) {
+                    value = (value << 1) | bit(e, k - 1);
+                }
+
+                const limb *const power = &table[(value / 2) * n];
+                if (first) {
+                    std::copy(power, power + n, result.begin());
+                    first = false;
+                } else {
+                    for (size_t k = j; k < i; k++) {
+                        kernels::mont_sqr(result.data(), result.data(), m, n, inv, t);
+                    }
+                    kernels::mont_mul(result.data(), result.data(), power, m, n, inv, t);
+                }
+                i = j;
+            }
+        }
+
+        // Leaving of Montgomery's form: result / R
+        std::copy(result.begin(), result.end(), t);
+        std::fill(t + n, t + 2 * n, 0);
+        kernels::redc(result.data(), t, m, n, inv);
+        return fromLimbs(result.data());
+    }
+
+    const BigInt &Montgomery::modulus() const {
+        return mod;
+    }
+
+    // Barrett's reduction
+    void Reducer::reduce(BigInt &dst, const BigInt &a, std::vector<limb> &u, std::vector<limb> &q) const {
+        const limb *const m = mod.numberArr.data();
+        const size_t length = kernels::normalizedSize(a.numberArr.data(), a.numberArr.size());
+        const bool negative = a.isNegative;
+
+        if (length < n || (length == n && kernels::cmp(a.numberArr.data(), m, n) < 0)) {
+            if (&dst != &a) {
+                dst.numberArr = a.numberArr;
+            }
+        } else if (inverse.empty()) {
+            // Short modulus: Knuth's division is faster than two multiplications
+            u.assign(a.numberArr.data(), a.numberArr.data() + length);
+            q.resize(length - n + 1);
+            dst.numberArr.resize(n);
+            kernels::divrem(q.data(), dst.numberArr.data(), u.data(), length, m, n);
+        } else {
+            // Shifted number gets one more limb, so its high part is less than normalized modulus
+            u.resize(length + 1);
+            if (shift) {
+                u[length] = kernels::lshift(u.data(), a.numberArr.data(), length, shift);
+            } else {
+                std::copy(a.numberArr.data(), a.numberArr.data() + length, u.begin());
+                u[length] = 0;
+            }
+            q.resize(length - n + 2);
+            dst.numberArr.resize(n);
+            kernels::divrem_preinv(q.data(), dst.numberArr.data(), u.data(), length + 1,
+                                   normalized.data(), n, inverse.data());
+            if (shift) {
+                kernels::rshift(dst.numberArr.data(), dst.numberArr.data(), n, shift);
+            }
+        }
+        dst.fixMagnitude(false);
+
+        // Remainder of negative number is taken from modulus
+        if (negative && dst != ZERO) {
+            dst.numberArr.resize(n);
+            kernels::sub(dst.numberArr.data(), m, n, dst.numberArr.data(), n);
+            dst.fixMagnitude(false);
+        }
+    }
+
+    Reducer::Reducer(const BigInt &modulus) :
+            mod(modulus.isNegative ? -modulus : modulus) {
+        if (mod == ZERO) {
+            throw std::invalid_argument("division by zero");
+        }
+        const limb *const m = mod.numberArr.data();
+        n     = kernels::normalizedSize(m, mod.numberArr.size());
+        shift = __builtin_clzll(m[n - 1]);
+        if (n < BARRETT_THRESHOLD) {
+            return;
+        }
+
+        normalized.assign(m, m + n);
+        if (shift) {
+            kernels::lshift(normalized.data(), m, n, shift);
+        }
+        inverse.resize(n + 1);
+        kernels::invert(inverse.data(), normalized.data(), n);
+    }
+
+    BigInt Reducer::reduce(const BigInt &a) const {
+        BigInt forRet(a.resource());
+        reduce(forRet, a);
+        return forRet;
+    }
+
+    void Reducer::reduce(BigInt &dst, const BigInt &a) const {
+        reduce(dst, a, reducerScratch(0), reducerScratch(1));
+    }
+
+    void Reducer::reduce(BigInt *numbers, size_t count) const {
+        std::vector<limb> &u = reducerScratch(0);
+        std::vector<limb> &q = reducerScratch(1);
+        for (size_t i = 0; i < count; i++) {
+            reduce(numbers[i], numbers[i], u, q);
+        }
+    }
+
+    const BigInt &Reducer::modulus() const {
+        return mod;
+    }
+
+    BigInt powmod(const BigInt &base, const BigInt &exponent, const BigInt &modulus) {
+        const BigInt m(modulus.isNegative ? -modulus : modulus);
+        if (m == ZERO) {
+            throw std::invalid_argument("division by zero");
+        }
+        if (m.numberArr[0] & 1) {
+            return Montgomery(m).pow(base, exponent);
+        }
+        if (exponent.isNegative) {
+            throw std::invalid_argument("negative exponent");
+        }
+
+        // Even modulus: left-to-right square-and-multiply, every product is reduced by Barrett's method
+        const Reducer reducer(m);
+        const BigInt x(reducer.reduce(base));
+        BigInt forRet(reducer.reduce(ONE));
+        BigInt product;
+        const limb *const e = exponent.numberArr.data();
+        for (size_t i = bitLength(e, exponent.numberArr.size()); i > 0; i--) {
+            mul(product, forRet, forRet);
+            reducer.reduce(forRet, product);
+            if (bit(e, i - 1)) {
+                mul(product, forRet, x);
+                reducer.reduce(forRet, product);
+            }
+        }
+        return forRet;
+    }
+}
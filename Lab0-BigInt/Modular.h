@@ -0,0 +1,106 @@
+#pragma once
+
+#include "BigInt.h"
+
+#ifndef tuple
+#include <tuple>
+#endif
+
+#ifndef vector
+#include <vector>
+#endif
+
+namespace LongMath
+{
+    // Montgomery's form of numbers modulo odd m: number a is kept as a * R mod m,
+    // where R = 2^(64n) and n is length of m in limbs
+    // Product of such numbers needs no division: (aR * bR) / R = abR mod m,
+    // and division by R is only shift after adding of multiple of m (Montgomery's reduction)
+    // Context is made once for modulus and may be used for many exponentiations
+    class Montgomery {
+    public:
+        // Modulus must be positive and odd, otherwise std::invalid_argument is thrown
+        explicit Montgomery(const BigInt &modulus);
+
+        // Returns a * R mod m, a may be negative or greater than modulus
+        [[nodiscard]] BigInt toForm(const BigInt &) const;
+        // Returns a / R mod m for number in Montgomery's form
+        [[nodiscard]] BigInt fromForm(const BigInt &) const;
+        // Returns a * b / R mod m, so product of numbers in Montgomery's form stays in it
+        [[nodiscard]] BigInt multiply(const BigInt &, const BigInt &) const;
+
+        // Returns base^exponent mod m for usual (not Montgomery's) numbers, result is in [0, m)
+        // Uses sliding window exponentiation: odd powers base, base^3, ... are taken from table,
+        // so there is one multiplication per window of bits instead of one per set bit
+        // Squarings take about half of products of multiplications (see kernels::mont_sqr),
+        // temporary limbs are kept between calls, so loop of exponentiation does not allocate
+        // Negative exponent calls std::invalid_argument
+        [[nodiscard]] BigInt pow(const BigInt &base, const BigInt &exponent) const;
+
+        [[nodiscard]] const BigInt &modulus() const;
+
+    private:
+        BigInt            mod;
+        size_t            n;
+        limb              inv;          // -1 / m mod 2^64
+        std::vector<limb> one;          // R mod m with n limbs
+        std::vector<limb> square;       // R^2 mod m with n limbs
+
+        // Writes a mod m (in [0, m)) to r with n limbs
+        void reduce(limb *r, const BigInt &a) const;
+        // Makes number from n limbs of a
+        [[nodiscard]] BigInt fromLimbs(const limb *a) const;
+    };
+
+    // Barrett's reduction by fixed modulus: reciprocal of modulus is found once,
+    // then remainder of number below modulus^2 takes two multiplications and no division
+    // Bigger numbers are reduced by pieces with same cost per piece
+    // Modulus shorter than BARRETT_THRESHOLD limbs uses Knuth's division instead, which is faster there
+    class Reducer {
+    public:
+        // Sign of modulus is ignored, zero modulus calls std::invalid_argument
+        explicit Reducer(const BigInt &modulus);
+
+        // Returns a mod |m| in [0, |m|), also for negative a
+        [[nodiscard]] BigInt reduce(const BigInt &) const;
+        // Writes a mod |m| to dst using its memory, dst may be same as a
+        void reduce(BigInt &dst, const BigInt &a) const;
+        // Reduces count numbers from array in place
+        void reduce(BigInt *numbers, size_t count) const;
+
+        // Returns |m|
+        [[nodiscard]] const BigInt &modulus() const;
+
+    private:
+        BigInt            mod;
+        size_t            n;
+        unsigned          shift;
+        std::vector<limb> normalized;   // |m| << shift, so lead bit is set
+        std::vector<limb> inverse;      // Reciprocal of normalized modulus (see kernels::invert),
+                                        // empty for short modulus
+
+        // Does reduce with given temporary arrays
+        void reduce(BigInt &dst, const BigInt &a, std::vector<limb> &u, std::vector<limb> &q) const;
+    };
+
+    // Returns base^exponent mod |modulus|, result is in [0, |modulus|)
+    // Odd modulus uses Montgomery's context (see above),
+    // even one uses square-and-multiply with Barrett's reduction (see Reducer) after every step
+    // Zero modulus and negative exponent call std::invalid_argument
+    BigInt powmod(const BigInt &base, const BigInt &exponent, const BigInt &modulus);
+
+    // Greatest common divisor of |a| and |b|, gcd(0, 0) = 0
+    // Uses Lehmer's steps on 62 high bits, long numbers are reduced by half gcd (see GCD_DC_THRESHOLD)
+    BigInt gcd(const BigInt &a, const BigInt &b);
+
+    // Least common multiple of |a| and |b|, lcm(a, 0) = 0
+    BigInt lcm(const BigInt &a, const BigInt &b);
+
+    // Returns g = gcd(a, b) and cofactors s, t with g = s * a + t * b
+    // Cofactors are least ones: |s| <= |b| / 2g (s = 1 or -1 if b = 0)
+    std::tuple<BigInt, BigInt, BigInt> xgcd(const BigInt &a, const BigInt &b);
+
+    // Returns x in [0, |m|) with a * x = 1 mod m
+    // Calls std::invalid_argument if m = 0 or gcd(a, m) != 1
+    BigInt modinv(const BigInt &a, const BigInt &m);
+}
@@ -0,0 +1,368 @@
+#include "Kernels.h"
+
+#ifndef algorithm
+#include <algorithm>
+#endif
+
+#ifndef vector
+#include <vector>
+#endif
+
+// Multiplication of magnitudes
+// All algorithms take their temporary arrays from one workspace, which is allocated
+// once in kernels::mul, every recursive call gets part of workspace after used one
+// Parts, which run in parallel, allocate own workspaces
+namespace LongMath::kernels {
+    namespace {
+        // r += a, an <= rn, carry goes up to r[rn - 1]
+        void addInPlace(limb *r, size_t rn, const limb *a, size_t an) {
+            add(r, r, rn, a, an);
+        }
+
+        // r = |a - b| for a and b with same length n, returns true if a < b
+        bool absDiff(limb *r, const limb *a, const limb *b, size_t n) {
+            if (cmp(a, b, n) < 0) {
+                sub_n(r, b, a, n);
+                return true;
+            }
+            sub_n(r, a, b, n);
+            return false;
+        }
+
+        //
+        // Signed helpers for Toom-3: numbers are stored in two's complement in w limbs
+        //
+
+        bool isNegativeSigned(const limb *a, size_t w) {
+            return a[w - 1] >> (LIMB_WIDTH - 1);
+        }
+
+        void negateSigned(limb *a, size_t w) {
+            limb carry = 1;
+            for (size_t i = 0; i < w; i++) {
+                a[i]  = ~a[i] + carry;
+                carry = carry && !a[i];
+            }
+        }
+
+        // a >>= 1 with sign extension
+        void halveSigned(limb *a, size_t w) {
+            const limb sign = a[w - 1] & (limb(1) << (LIMB_WIDTH - 1));
+            rshift(a, a, w, 1);
+            a[w - 1] |= sign;
+        }
+
+        // Exact division by 3 modulo 2^(w * LIMB_WIDTH), works for negative numbers too
+        void divExactBy3(limb *a, size_t w) {
+            // 3 * 0xAAAAAAAAAAAAAAAB == 1 modulo 2^64
+            const limb inverse3 = 0xAAAAAAAAAAAAAAABULL;
+            limb borrow = 0;
+            for (size_t i = 0; i < w; i++) {
+                const limb cur  = a[i] - borrow;
+                const limb less = a[i] < borrow;
+                a[i]   = cur * inverse3;
+                borrow = limb((dlimb(a[i]) * 3) >> LIMB_WIDTH) + less;
+            }
+        }
+
+        void copyPadded(limb *r, size_t w, const limb *a, size_t n) {
+            std::copy(a, a + n, r);
+            std::fill(r + n, r + w, 0);
+        }
+
+        size_t balancedScratch(size_t n);
+
+        size_t scratchSize(size_t an, size_t bn) {
+            if (bn < KARATSUBA_THRESHOLD || bn >= NTT_THRESHOLD) {
+                return 0;
+            }
+            if (an == bn) {
+                return balancedScratch(bn);
+            }
+            const size_t rest = an % bn;
+            return 2 * bn + std::max(balancedScratch(bn), rest ? scratchSize(bn, rest) : 0);
+        }
+
+        size_t balancedScratch(size_t n) {
+            if (n < KARATSUBA_THRESHOLD || n >= NTT_THRESHOLD) {
+                return 0;
+            }
+            if (n < TOOM3_THRESHOLD) {
+                const size_t h = (n + 1) / 2;
+                return 6 * h + 1 + balancedScratch(h);
+            }
+            const size_t k = (n + 2) / 3;
+            return 9 * (k + 2) + 5 * (2 * k + 4) + balancedScratch(k + 1);
+        }
+
+        void mulRecursive(limb *r, const limb *a, size_t an, const limb *b, size_t bn, limb *ws, size_t threads);
+
+        // Product, which is part of bigger multiplication, an >= bn
+        // Parts, which run in parallel, must not share workspace, so ws is nullptr for them
+        // and workspace is allocated here
+        void mulPart(limb *r, const limb *a, size_t an, const limb *b, size_t bn, limb *ws, size_t threads) {
+            if (ws) {
+                mulRecursive(r, a, an, b, bn, ws, threads);
+                return;
+            }
+            std::vector<limb> workspace(scratchSize(an, bn));
+            mulRecursive(r, a, an, b, bn, workspace.data(), threads);
+        }
+
+        // Returns number of threads for parts of multiplication, where shorter operand has length n
+        size_t partThreads(size_t n, size_t threads) {
+            return n >= PARALLEL_MUL_THRESHOLD ? threads : 1;
+        }
+
+        // Karatsuba for a and b with same length n:
+        // a * b = z2 * B^2h + (z0 + z2 - (a0 - a1)(b0 - b1)) * B^h + z0
+        void karatsuba(limb *r, const limb *a, const limb *b, size_t n, limb *ws, size_t threads) {
+            const size_t h = (n + 1) / 2;
+            const size_t l = n - h;
+
+            limb *const da  = ws;
+            limb *const db  = da + h;
+            limb *const d   = db + h;
+            limb *const mid = d  + 2 * h;
+            limb *const next = mid + 2 * h + 1;
+
+            // Differences of halves, high halves are padded by zeros to length h
+            // Square takes one difference, so all three products are squares
+            const bool square = a == b;
+            copyPadded(da, h, a + h, l);
+            bool negative = absDiff(da, a, da, h);
+            if (square) {
+                negative = false;
+            } else {
+                copyPadded(db, h, b + h, l);
+                negative = negative != absDiff(db, b, db, h);
+            }
+
+            // z0, z2 and (a0 - a1)(b0 - b1)
+            limb *const products[3] = {r, r + 2 * h, d};
+            const limb *const xs[3] = {a, a + h, da};
+            const limb *const ys[3] = {b, b + h, square ? da : db};
+            const size_t lengths[3] = {h, l, h};
+            threads = partThreads(n, threads);
+            parallel(threads, 3, [&](size_t i, size_t share) {
+                mulPart(products[i], xs[i], lengths[i], ys[i], lengths[i], threads > 1 ? nullptr : next, share);
+            });
+
+            // mid = z0 + z2 -+ d, it is not negative
+            mid[2 * h] = add(mid, r, 2 * h, r + 2 * h, 2 * l);
+            if (negative) {
+                mid[2 * h] += add_n(mid, mid, d, 2 * h);
+            } else {
+                mid[2 * h] -= sub_n(mid, mid, d, 2 * h);
+            }
+
+            addInPlace(r + h, 2 * n - h, mid, std::min(2 * h + 1, 2 * n - h));
+        }
+
+        // Evaluates x = x0 + x1 * B^k + x2 * B^2k in points 1, -1 and -2
+        // Values are written in two's complement with length e = k + 2
+        void toomEvaluate(limb *p1, limb *pm1, limb *pm2, limb *parts,
+                          const limb *x, size_t k, size_t s, size_t e) {
+            limb *const x0 = parts;
+            limb *const x1 = x0 + e;
+            limb *const x2 = x1 + e;
+            copyPadded(x0, e, x,         k);
+            copyPadded(x1, e, x + k,     k);
+            copyPadded(x2, e, x + 2 * k, s);
+
+            add_n(pm2, x0, x2, e);              // x0 + x2
+            add_n(p1,  pm2, x1, e);             // p(1)  = x0 + x1 + x2
+            sub_n(pm1, pm2, x1, e);             // p(-1) = x0 - x1 + x2
+            add_n(pm2, pm1, x2, e);
+            lshift(pm2, pm2, e, 1);
+            sub_n(pm2, pm2, x0, e);             // p(-2) = (p(-1) + x2) * 2 - x0
+        }
+
+        // Multiplies signed values with length e, writes signed product with length w
+        void toomPointwise(limb *r, size_t w, limb *x, limb *y, size_t e, limb *ws, size_t threads) {
+            const bool xNegative = isNegativeSigned(x, e);
+            const bool yNegative = isNegativeSigned(y, e);
+            if (xNegative) {
+                negateSigned(x, e);
+            }
+            if (yNegative) {
+                negateSigned(y, e);
+            }
+            // Magnitudes are less than B^(e - 1)
+            mulPart(r, x, e - 1, y, e - 1, ws, threads);
+            std::fill(r + 2 * (e - 1), r + w, 0);
+            if (xNegative != yNegative) {
+                negateSigned(r, w);
+            }
+        }
+
+        // Toom-3 for a and b with same length n, evaluation in points 0, 1, -1, -2, infinity
+        // and Bodrato's interpolation sequence
+        void toom3(limb *r, const limb *a, const limb *b, size_t n, limb *ws, size_t threads) {
+            const size_t k = (n + 2) / 3;
+            const size_t s = n - 2 * k;
+            const size_t e = k + 2;
+            const size_t w = 2 * k + 4;
+
+            limb *const a1   = ws;
+            limb *const am1  = a1  + e;
+            limb *const am2  = am1 + e;
+            limb *const b1   = am2 + e;
+            limb *const bm1  = b1  + e;
+            limb *const bm2  = bm1 + e;
+            limb *const parts = bm2 + e;
+            limb *const r0   = parts + 3 * e;
+            limb *const r1   = r0  + w;
+            limb *const rm1  = r1  + w;
+            limb *const rm2  = rm1 + w;
+            limb *const rinf = rm2 + w;
+            limb *const next = rinf + w;
+
+            toomEvaluate(a1, am1, am2, parts, a, k, s, e);
+            toomEvaluate(b1, bm1, bm2, parts, b, k, s, e);
+
+            threads = partThreads(n, threads);
+            limb *const workspace = threads > 1 ? nullptr : next;
+            parallel(threads, 5, [&](size_t i, size_t share) {
+                switch (i) {
+                    case 0:
+                        mulPart(r0, a, k, b, k, workspace, share);
+                        std::fill(r0 + 2 * k, r0 + w, 0);
+                        break;
+                    case 1:
+                        mulPart(rinf, a + 2 * k, s, b + 2 * k, s, workspace, share);
+                        std::fill(rinf + 2 * s, rinf + w, 0);
+                        break;
+                    case 2:
+                        toomPointwise(r1,  w, a1,  b1,  e, workspace, share);
+                        break;
+                    case 3:
+                        toomPointwise(rm1, w, am1, bm1, e, workspace, share);
+                        break;
+                    default:
+                        toomPointwise(rm2, w, am2, bm2, e, workspace, share);
+                }
+            });
+
+            // After interpolation r0, r1, rm1 (as r2), rm2 (as r3) and rinf
+            // are coefficients of product
+            limb *const r2 = rm1;
+            limb *const r3 = rm2;
+            sub_n(r3, rm2, r1, w);
+            divExactBy3(r3, w);                 // r3 = (r(-2) - r(1)) / 3
+            sub_n(r1, r1, rm1, w);
+            halveSigned(r1, w);                 // r1 = (r(1) - r(-1)) / 2
+            sub_n(r2, rm1, r0, w);              // r2 = r(-1) - r(0)
+            sub_n(r3, r2, r3, w);
+            halveSigned(r3, w);
+            add_n(r3, r3, rinf, w);
+            add_n(r3, r3, rinf, w);             // r3 = (r2 - r3) / 2 + 2 * r(inf)
+            add_n(r2, r2, r1, w);
+            sub_n(r2, r2, rinf, w);             // r2 = r2 + r1 - r(inf)
+            sub_n(r1, r1, r3, w);               // r1 = r1 - r3
+
+            std::copy(r0, r0 + 2 * k, r);
+            std::fill(r + 2 * k, r + 4 * k, 0);
+            std::copy(rinf, rinf + 2 * s, r + 4 * k);
+            addInPlace(r + k,     2 * n - k,     r1, std::min(w, 2 * n - k));
+            addInPlace(r + 2 * k, 2 * n - 2 * k, r2, std::min(w, 2 * n - 2 * k));
+            addInPlace(r + 3 * k, 2 * n - 3 * k, r3, std::min(w, 2 * n - 3 * k));
+        }
+
+        // Unbalanced operands in parallel: a is cut in chunks with whole number of pieces with length bn,
+        // every chunk is multiplied by b in own array, and products are added after all of them are found
+        void mulChunks(limb *r, const limb *a, size_t an, const limb *b, size_t bn, size_t threads) {
+            const size_t pieces = (an + bn - 1) / bn;
+            const size_t chunks = std::min(threads, pieces);
+            std::vector<std::vector<limb>> products(chunks);
+            parallel(threads, chunks, [&](size_t i, size_t share) {
+                const size_t begin  = pieces * i / chunks * bn;
+                const size_t length = std::min(pieces * (i + 1) / chunks * bn, an) - begin;
+                products[i].resize(length + bn);
+                if (length >= bn) {
+                    mulPart(products[i].data(), a + begin, length, b, bn, nullptr, share);
+                } else {
+                    mulPart(products[i].data(), b, bn, a + begin, length, nullptr, share);
+                }
+            });
+
+            std::fill(r, r + an + bn, 0);
+            for (size_t i = 0; i < chunks; i++) {
+                const size_t begin = pieces * i / chunks * bn;
+                addInPlace(r + begin, an + bn - begin, products[i].data(), products[i].size());
+            }
+        }
+
+        // an >= bn
+        void mulRecursive(limb *r, const limb *a, size_t an, const limb *b, size_t bn, limb *ws, size_t threads) {
+            if (bn >= NTT_THRESHOLD) {
+                mul_ntt(r, a, an, b, bn, threads);
+                return;
+            }
+            if (a == b && an == bn && bn < KARATSUBA_SQR_THRESHOLD) {
+                sqr_basecase(r, a, an);
+                return;
+            }
+            if (bn < KARATSUBA_THRESHOLD) {
+                mul_basecase(r, a, an, b, bn);
+                return;
+            }
+            if (an == bn) {
+                if (bn < TOOM3_THRESHOLD) {
+                    karatsuba(r, a, b, bn, ws, threads);
+                } else {
+                    toom3(r, a, b, bn, ws, threads);
+                }
+                return;
+            }
+            threads = partThreads(bn, threads);
+            if (threads > 1) {
+                mulChunks(r, a, an, b, bn, threads);
+                return;
+            }
+
+            // Unbalanced operands: a is cut in pieces with length bn
+            limb *const piece = ws;
+            limb *const next  = ws + 2 * bn;
+            std::fill(r, r + an + bn, 0);
+            for (size_t i = 0; i < an; i += bn) {
+                const size_t length = std::min(bn, an - i);
+                if (length == bn) {
+                    mulRecursive(piece, a + i, bn, b, bn, next, 1);
+                } else {
+                    mulRecursive(piece, b, bn, a + i, length, next, 1);
+                }
+                addInPlace(r + i, an + bn - i, piece, length + bn);
+            }
+        }
+    }
+
+    size_t mul_scratch_size(size_t an, size_t bn) {
+        return an < bn ? scratchSize(bn, an) : scratchSize(an, bn);
+    }
+
+    void mul_scratch(limb *r, const limb *a, size_t an, const limb *b, size_t bn, limb *scratch) {
+        if (an < bn) {
+            std::swap(a, b);
+            std::swap(an, bn);
+        }
+        if (!bn) {
+            std::fill(r, r + an, 0);
+            return;
+        }
+        mulRecursive(r, a, an, b, bn, scratch, 1);
+    }
+
+    void mul(limb *r, const limb *a, size_t an, const limb *b, size_t bn, size_t threads) {
+        if (an < bn) {
+            std::swap(a, b);
+            std::swap(an, bn);
+        }
+        if (!bn) {
+            std::fill(r, r + an, 0);
+            return;
+        }
+        std::vector<limb> workspace(scratchSize(an, bn));
+        mulRecursive(r, a, an, b, bn, workspace.data(), threads);
+    }
+}
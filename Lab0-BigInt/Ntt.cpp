@@ -0,0 +1,249 @@
+#include "Kernels.h"
+
+#ifndef algorithm
+#include <algorithm>
+#endif
+
+#ifndef vector
+#include <vector>
+#endif
+
+// Multiplication with number theoretic transform
+// Every limb is one coefficient of polynomial, so convolution is computed modulo three
+// primes below 2^62 and restored by chinese remainder theorem (Garner's algorithm):
+// coefficient is less than n * 2^128, which is much less than product of primes
+namespace LongMath::kernels {
+    namespace {
+        // Prime p = k * 2^45 + 1 with arithmetic in Montgomery form (R = 2^64)
+        class Modulus {
+        public:
+            constexpr Modulus(limb p, limb g) :
+                p(p),
+                g(g),
+                pInverse(inverse(p)),
+                r2(limb((dlimb(1) << LIMB_WIDTH) % p * (dlimb(1) << LIMB_WIDTH) % p)) {}
+
+            [[nodiscard]] constexpr limb reduce(dlimb t) const {
+                const limb m = limb(t) * pInverse;
+                const limb u = limb((t + dlimb(m) * p) >> LIMB_WIDTH);
+                return u >= p ? u - p : u;
+            }
+
+            [[nodiscard]] constexpr limb mul(limb a, limb b) const {
+                return reduce(dlimb(a) * b);
+            }
+
+            [[nodiscard]] constexpr limb add(limb a, limb b) const {
+                const limb sum = a + b;
+                return sum >= p ? sum - p : sum;
+            }
+
+            [[nodiscard]] constexpr limb sub(limb a, limb b) const {
+                return a >= b ? a - b : a + p - b;
+            }
+
+            // Converts number less than 2^64 to Montgomery form
+            [[nodiscard]] constexpr limb toMontgomery(limb a) const {
+                return mul(a % p, r2);
+            }
+
+            [[nodiscard]] constexpr limb fromMontgomery(limb a) const {
+                return reduce(a);
+            }
+
+            [[nodiscard]] constexpr limb pow(limb a, limb e) const {
+                limb forRet = toMontgomery(1);
+                for (; e; e >>= 1) {
+                    if (e & 1) {
+                        forRet = mul(forRet, a);
+                    }
+                    a = mul(a, a);
+                }
+                return forRet;
+            }
+
+            const limb p;
+            const limb g;                   // Primitive root
+
+        private:
+            // -p^(-1) modulo 2^64 by Newton's iteration
+            static constexpr limb inverse(limb p) {
+                limb x = p;
+                for (int i = 0; i < 6; i++) {
+                    x *= 2 - p * x;
+                }
+                return ~x + 1;
+            }
+
+            const limb pInverse;
+            const limb r2;                  // 2^128 modulo p
+        };
+
+        constexpr Modulus PRIMES[3] = {
+            Modulus(4611615649683210241ULL, 11),
+            Modulus(4610208274799656961ULL, 3),
+            Modulus(4609610140474146817ULL, 10)
+        };
+
+        // Roots of unity w^0, w^1, ..., w^(n/2 - 1) for w of order n, in Montgomery form
+        std::vector<limb> rootsOfUnity(const Modulus &mod, size_t n, bool inverse) {
+            limb w = mod.pow(mod.toMontgomery(mod.g), (mod.p - 1) / n);
+            if (inverse) {
+                w = mod.pow(w, n - 1);
+            }
+            std::vector<limb> forRet(n / 2);
+            limb cur = mod.toMontgomery(1);
+            for (limb &root: forRet) {
+                root = cur;
+                cur  = mod.mul(cur, w);
+            }
+            return forRet;
+        }
+
+        // Transforms of a with length n take roots of order n as roots[j * step]
+        // Outer level of transform joins two independent transforms of halves,
+        // so long transform in parallel splits butterflies of outer level between threads
+        // and gives halves to two groups of threads (see PARALLEL_MUL_THRESHOLD)
+        bool isParallel(size_t n, size_t threads) {
+            return threads > 1 && n / 2 >= PARALLEL_MUL_THRESHOLD;
+        }
+
+        // One level of transform: butterflies from begin to end in every block with length 2 * half
+        // Modulus is taken by value, so its fields stay in registers (writes to a can not change them)
+        void forwardLevel(limb *a, size_t n, size_t half, const Modulus mod, const limb *roots, size_t step,
+                          size_t begin, size_t end) {
+            for (size_t i = 0; i < n; i += 2 * half) {
+                for (size_t j = begin; j < end; j++) {
+                    const limb u = a[i + j];
+                    const limb v = a[i + j + half];
+                    a[i + j]        = mod.add(u, v);
+                    a[i + j + half] = mod.mul(mod.sub(u, v), roots[j * step]);
+                }
+            }
+        }
+
+        void backwardLevel(limb *a, size_t n, size_t half, const Modulus mod, const limb *roots, size_t step,
+                           size_t begin, size_t end) {
+            for (size_t i = 0; i < n; i += 2 * half) {
+                for (size_t j = begin; j < end; j++) {
+                    const limb u = a[i + j];
+                    const limb v = mod.mul(a[i + j + half], roots[j * step]);
+                    a[i + j]        = mod.add(u, v);
+                    a[i + j + half] = mod.sub(u, v);
+                }
+            }
+        }
+
+        // Gentleman-Sande transform, result is in bit reversed order
+        void forward(limb *a, size_t n, const Modulus &mod, const limb *roots, size_t step, size_t threads) {
+            if (isParallel(n, threads)) {
+                const size_t half = n / 2;
+                parallel(threads, threads, [&](size_t i, size_t) {
+                    forwardLevel(a, n, half, mod, roots, step, half * i / threads, half * (i + 1) / threads);
+                });
+                parallel(threads, 2, [&](size_t i, size_t share) {
+                    forward(a + i * half, half, mod, roots, 2 * step, share);
+                });
+                return;
+            }
+            for (size_t half = n / 2; half; half >>= 1, step <<= 1) {
+                forwardLevel(a, n, half, mod, roots, step, 0, half);
+            }
+        }
+
+        // Cooley-Tukey transform from bit reversed order, result is not divided by n
+        void backward(limb *a, size_t n, const Modulus &mod, const limb *roots, size_t step, size_t threads) {
+            if (isParallel(n, threads)) {
+                const size_t half = n / 2;
+                parallel(threads, 2, [&](size_t i, size_t share) {
+                    backward(a + i * half, half, mod, roots, 2 * step, share);
+                });
+                parallel(threads, threads, [&](size_t i, size_t) {
+                    backwardLevel(a, n, half, mod, roots, step, half * i / threads, half * (i + 1) / threads);
+                });
+                return;
+            }
+            for (size_t half = 1, levelStep = step * n / 2; half < n; half <<= 1, levelStep >>= 1) {
+                backwardLevel(a, n, half, mod, roots, levelStep, 0, half);
+            }
+        }
+
+        // Cyclic convolution of a and b modulo prime, returns residues (not in Montgomery form)
+        // Transforms of a and b run in parallel, when threads > 1
+        std::vector<limb> convolution(const limb *a, size_t an, const limb *b, size_t bn,
+                                      size_t n, const Modulus &mod, size_t threads) {
+            const std::vector<limb> roots(rootsOfUnity(mod, n, false));
+            // Square takes one forward transform
+            const bool square = a == b && an == bn;
+            std::vector<limb> x(n, 0);
+            std::vector<limb> y(square ? 0 : n, 0);
+            parallel(threads, square ? 1 : 2, [&](size_t i, size_t share) {
+                std::vector<limb> &z       = i ? y : x;
+                const limb *const source   = i ? b : a;
+                const size_t length        = i ? bn : an;
+                for (size_t j = 0; j < length; j++) {
+                    z[j] = mod.toMontgomery(source[j]);
+                }
+                forward(z.data(), n, mod, roots.data(), 1, share);
+            });
+
+            const std::vector<limb> &factor = square ? x : y;
+            for (size_t i = 0; i < n; i++) {
+                x[i] = mod.mul(x[i], factor[i]);
+            }
+            backward(x.data(), n, mod, rootsOfUnity(mod, n, true).data(), 1, threads);
+
+            const limb nInverse = mod.pow(mod.toMontgomery(n), mod.p - 2);
+            for (limb &c: x) {
+                c = mod.fromMontgomery(mod.mul(c, nInverse));
+            }
+            return x;
+        }
+
+        // Inverse of a modulo p, where a < p
+        limb inverseModulo(limb a, const Modulus &mod) {
+            return mod.fromMontgomery(mod.pow(mod.toMontgomery(a), mod.p - 2));
+        }
+    }
+
+    void mul_ntt(limb *r, const limb *a, size_t an, const limb *b, size_t bn, size_t threads) {
+        size_t n = 1;
+        while (n < an + bn) {
+            n <<= 1;
+        }
+
+        std::vector<limb> residues[3];
+        parallel(threads, 3, [&](size_t i, size_t share) {
+            residues[i] = convolution(a, an, b, bn, n, PRIMES[i], share);
+        });
+
+        const Modulus &m1 = PRIMES[0];
+        const Modulus &m2 = PRIMES[1];
+        const Modulus &m3 = PRIMES[2];
+        // Constants of Garner's algorithm in Montgomery form
+        const limb p1Inverse2 = m2.toMontgomery(inverseModulo(m1.p % m2.p, m2));
+        const limb p1Inverse3 = m3.toMontgomery(inverseModulo(m1.p % m3.p, m3));
+        const limb p2Inverse3 = m3.toMontgomery(inverseModulo(m2.p % m3.p, m3));
+        const dlimb p1p2 = dlimb(m1.p) * m2.p;
+
+        std::fill(r, r + an + bn, 0);
+        for (size_t i = 0; i + 1 < an + bn; i++) {
+            // x = v1 + v2 * p1 + v3 * p1 * p2
+            const limb v1 = residues[0][i];
+            const limb v2 = m2.fromMontgomery(m2.mul(m2.toMontgomery(m2.sub(residues[1][i] % m2.p, v1 % m2.p)),
+                                                     p1Inverse2));
+            limb v3 = m3.sub(residues[2][i], v1 % m3.p);
+            v3 = m3.mul(m3.toMontgomery(v3), p1Inverse3);
+            v3 = m3.sub(v3, m3.toMontgomery(v2 % m3.p));
+            v3 = m3.fromMontgomery(m3.mul(v3, p2Inverse3));
+
+            // v3 * p1p2 + v2 * p1 + v1 is less than 2^192, so it has three limbs
+            const dlimb low  = dlimb(v2) * m1.p + v1;
+            const dlimb mid  = dlimb(v3) * limb(p1p2) + limb(low);
+            const dlimb high = dlimb(v3) * limb(p1p2 >> LIMB_WIDTH) + limb(low >> LIMB_WIDTH) + (mid >> LIMB_WIDTH);
+            const limb x[3] = {limb(mid), limb(high), limb(high >> LIMB_WIDTH)};
+
+            add(r + i, r + i, an + bn - i, x, std::min<size_t>(3, an + bn - i));
+        }
+    }
+}
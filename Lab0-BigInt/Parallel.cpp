@@ -0,0 +1,167 @@
+#include "Kernels.h"
+
+#ifndef algorithm
+#include <algorithm>
+#endif
+
+#ifndef condition_variable
+#include <condition_variable>
+#endif
+
+#ifndef deque
+#include <deque>
+#endif
+
+#ifndef exception
+#include <exception>
+#endif
+
+#ifndef mutex
+#include <mutex>
+#endif
+
+#ifndef thread
+#include <thread>
+#endif
+
+#ifndef vector
+#include <vector>
+#endif
+
+// Pool of threads for long multiplication
+// Task, which waits for its calls, does queued calls meanwhile, so nested parallel
+// can not take all workers and stop
+namespace LongMath::kernels {
+    namespace {
+        // Calls of one parallel, which are not done yet
+        struct Group {
+            size_t left;
+            std::exception_ptr error;
+        };
+
+        struct Job {
+            const std::function<void(size_t, size_t)> *task;
+            size_t index;
+            size_t share;
+            Group *group;
+        };
+
+        class ThreadPool {
+        public:
+            ThreadPool() = default;
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool &operator=(const ThreadPool&) = delete;
+
+            ~ThreadPool() {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stopped = true;
+                }
+                changed.notify_all();
+                for (std::thread &worker: workers) {
+                    worker.join();
+                }
+            }
+
+            static ThreadPool &instance() {
+                static ThreadPool pool;
+                return pool;
+            }
+
+            // Starts workers, if there are less than count of them
+            void reserve(size_t count) {
+                std::lock_guard<std::mutex> lock(mutex);
+                while (workers.size() < count) {
+                    workers.emplace_back([this] { work(); });
+                }
+            }
+
+            // Calls with index from 1 go to queue, call 0 is done by calling thread
+            void run(const Job *jobs, size_t count) {
+                Group &group = *jobs[0].group;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    queue.insert(queue.end(), jobs + 1, jobs + count);
+                }
+                changed.notify_all();
+                execute(jobs[0]);
+
+                std::unique_lock<std::mutex> lock(mutex);
+                while (group.left) {
+                    if (queue.empty()) {
+                        changed.wait(lock);
+                        continue;
+                    }
+                    const Job job = queue.front();
+                    queue.pop_front();
+                    lock.unlock();
+                    execute(job);
+                    lock.lock();
+                }
+            }
+
+        private:
+            void work() {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (true) {
+                    changed.wait(lock, [this] { return stopped || !queue.empty(); });
+                    if (queue.empty()) {
+                        return;
+                    }
+                    const Job job = queue.front();
+                    queue.pop_front();
+                    lock.unlock();
+                    execute(job);
+                    lock.lock();
+                }
+            }
+
+            void execute(const Job &job) {
+                std::exception_ptr error;
+                try {
+                    (*job.task)(job.index, job.share);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if (error && !job.group->error) {
+                    job.group->error = error;
+                }
+                if (!--job.group->left) {
+                    changed.notify_all();
+                }
+            }
+
+            std::mutex mutex;
+            // Is notified, when calls are queued, group is done or pool is stopped
+            std::condition_variable changed;
+            std::deque<Job> queue;
+            std::vector<std::thread> workers;
+            bool stopped = false;
+        };
+    }
+
+    void parallel(size_t threads, size_t count, const std::function<void(size_t, size_t)> &task) {
+        if (threads <= 1 || count <= 1) {
+            for (size_t i = 0; i < count; i++) {
+                task(i, threads);
+            }
+            return;
+        }
+
+        ThreadPool &pool = ThreadPool::instance();
+        pool.reserve(threads - 1);
+
+        // Sum of (threads + i) / count for all i is threads
+        Group group{count, nullptr};
+        std::vector<Job> jobs(count);
+        for (size_t i = 0; i < count; i++) {
+            jobs[i] = {&task, i, std::max<size_t>(1, (threads + i) / count), &group};
+        }
+        pool.run(jobs.data(), count);
+        if (group.error) {
+            std::rethrow_exception(group.error);
+        }
+    }
+}
@@ -0,0 +1,188 @@
+#include "Roots.h"
+#include "Kernels.h"
+
+#ifndef vector
+#include <vector>
+#endif
+
+namespace LongMath {
+    namespace {
+        // Returns number of bits of a with length n without lead zero bits
+        size_t bitLength(const limb *a, size_t n) {
+            n = kernels::normalizedSize(a, n);
+            return n ? n * LIMB_WIDTH - __builtin_clzll(a[n - 1]) : 0;
+        }
+
+        size_t width(size_t x) {
+            return x ? LIMB_WIDTH - __builtin_clzll(x) : 0;
+        }
+
+        // Returns 64 bits of a with length n from given bit
+        limb bitsAt(const limb *a, size_t n, size_t shift) {
+            const size_t i = shift / LIMB_WIDTH;
+            const size_t k = shift % LIMB_WIDTH;
+            const limb low  = i < n ? a[i] : 0;
+            const limb high = i + 1 < n ? a[i + 1] : 0;
+            return k ? (low >> k) | (high << (LIMB_WIDTH - k)) : low;
+        }
+
+        // Left-to-right square-and-multiply
+        BigInt power(const BigInt &x, size_t k) {
+            BigInt forRet(ONE, x.resource());
+            BigInt product;
+            for (size_t i = width(k); i > 0; i--) {
+                mul(product, forRet, forRet);
+                std::swap(forRet, product);
+                if ((k >> (i - 1)) & 1) {
+                    mul(product, forRet, x);
+                    std::swap(forRet, product);
+                }
+            }
+            return forRet;
+        }
+
+        // Floor of k-th root of n > 0 with given number of bits, degree is k as BigInt
+        BigInt root(const BigInt &n, size_t bits, size_t k, const BigInt &degree) {
+            const size_t rootBits = (bits + k - 1) / k;
+            const size_t guard    = width(k) + 2;
+
+            if (rootBits <= 2 * guard + 32) {
+                // Short root is found bit by bit
+                BigInt forRet(n.resource());
+                for (size_t i = rootBits; i > 0; i--) {
+                    BigInt candidate(forRet + (ONE << (i - 1)));
+                    if (power(candidate, k) <= n) {
+                        forRet = std::move(candidate);
+                    }
+                }
+                return forRet;
+            }
+
+            // Root of high part is less than 2^shift away from root of n after shift and is over it,
+            // one Newton's step makes error about k 2^(2 shift - rootBits), which is less than 1
+            const size_t shift = (rootBits - guard) / 2;
+            BigInt x(root(n >> (k * shift), bits - k * shift, k, degree));
+            ++x;
+            x <<= shift;
+
+            // Newton's steps from number over root decrease it until it is floor of root
+            BigInt next(n.resource());
+            while (true) {
+                next  = n / power(x, k - 1);
+                next += x * degree - x;
+                next /= degree;
+                if (next >= x) {
+                    return x;
+                }
+                std::swap(x, next);
+            }
+        }
+
+        // Table of squares modulo m
+        class SquareTable {
+        public:
+            explicit SquareTable(limb m) :
+                    isSquare(m) {
+                for (limb i = 0; i < m; i++) {
+                    isSquare[i * i % m] = true;
+                }
+            }
+
+            bool operator()(limb r) const {
+                return isSquare[r % isSquare.size()];
+            }
+
+        private:
+            std::vector<bool> isSquare;
+        };
+    }
+
+    BigInt isqrt(const BigInt &n) {
+        if (n.isNegative) {
+            throw std::invalid_argument("square root of negative number");
+        }
+        const limb *const x = n.numberArr.data();
+        const size_t length = n.numberArr.size();
+        const size_t bits   = bitLength(x, length);
+        if (!bits) {
+            return ZERO;
+        }
+
+        // After step with d a is root of n >> 2 (c - d) with error at most 1 and has d + 1 bits,
+        // so d is doubled and new a is found by one division of 2d high bits of n
+        const size_t c = (bits - 1) / 2;
+        size_t d = 0;
+        size_t s = width(c);
+
+        // First steps work in single limb
+        limb small = 1;
+        for (; s > 0 && (c >> (s - 1)) <= 32; s--) {
+            const size_t e = d;
+            d = c >> (s - 1);
+            small = (small << (d - e - 1)) + bitsAt(x, length, 2 * c - e - d + 1) / small;
+        }
+
+        BigInt forRet(n.resource());
+        BigInt high(n.resource());
+        forRet.numberArr[0] = small;
+        for (; s > 0; s--) {
+            const size_t e = d;
+            d = c >> (s - 1);
+            high  = n >> (2 * c - e - d + 1);
+            high /= forRet;
+            forRet <<= d - e - 1;
+            forRet  += high;
+        }
+
+        mul(high, forRet, forRet);
+        if (high > n) {
+            --forRet;
+        }
+        return forRet;
+    }
+
+    BigInt iroot(const BigInt &n, size_t k) {
+        if (!k) {
+            throw std::invalid_argument("root of zero degree");
+        }
+        if (n.isNegative) {
+            if (!(k & 1)) {
+                throw std::invalid_argument("even root of negative number");
+            }
+            return -iroot(-n, k);
+        }
+        if (k == 1 || n <= ONE) {
+            return n;
+        }
+        if (k == 2) {
+            return isqrt(n);
+        }
+
+        BigInt degree(n.resource());
+        degree.numberArr[0] = k;
+        return root(n, bitLength(n.numberArr.data(), n.numberArr.size()), k, degree);
+    }
+
+    bool is_perfect_square(const BigInt &n) {
+        if (n.isNegative) {
+            return false;
+        }
+        static const SquareTable squares256(256);
+        static const SquareTable squares255(255);
+        static const SquareTable squares257(257);
+        static const SquareTable squares641(641);
+        static const SquareTable squares65537(65537);
+
+        const limb *const x = n.numberArr.data();
+        if (!squares256(x[0])) {
+            return false;
+        }
+        const limb r = kernels::mod_base_m1(x, n.numberArr.size());
+        if (!squares255(r) || !squares257(r) || !squares641(r) || !squares65537(r)) {
+            return false;
+        }
+
+        const BigInt floorRoot(isqrt(n));
+        return floorRoot * floorRoot == n;
+    }
+}
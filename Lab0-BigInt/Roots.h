@@ -0,0 +1,22 @@
+#pragma once
+
+#include "BigInt.h"
+
+namespace LongMath
+{
+    // Returns floor(sqrt(n)), negative n calls std::invalid_argument
+    // Newton's iteration doubles precision on every step: root of high 2k bits of n gives k bits of root,
+    // which are made 2k bits by one division of high 4k bits of n, so whole cost is about one long division
+    BigInt isqrt(const BigInt &n);
+
+    // Returns floor of k-th root of |n| with sign of n, so root is rounded to zero
+    // Root of high part of n is found recursively, then it is made precise by Newton's steps
+    // x = ((k - 1) x + n / x^(k - 1)) / k, which work at full precision only at the end
+    // k = 0 and negative n with even k call std::invalid_argument
+    BigInt iroot(const BigInt &n, size_t k);
+
+    // Returns true if n is square of integer
+    // Most of non-squares are rejected by residues modulo 256, 255, 257, 641 and 65537
+    // (last four are taken from remainder by 2^64 - 1), only rest of numbers take isqrt
+    bool is_perfect_square(const BigInt &n);
+}
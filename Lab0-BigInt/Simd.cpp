@@ -0,0 +1,550 @@
+#include "Kernels.h"
+
+#ifndef algorithm
+#include <algorithm>
+#endif
+
+#if defined(__x86_64__)
+#ifndef immintrin
+#include <immintrin.h>
+#endif
+#endif
+
+// Linear kernels, which go through limbs one by one: comparison, addition, subtraction, bitwise operations
+// and multiplication by one limb
+// Every kernel has portable loop, and on x86-64 also versions with AVX2, AVX-512 or MULX and ADX,
+// which are chosen by instructions of processor (see SIMD_KERNELS)
+// Addition in vector lanes finds carries by carry-lookahead on lane masks: lane generates carry
+// if its sum is less than argument, lane propagates carry if its sum has all ones, so carries into lanes are
+// ((generate << 1 | carry) + propagate) ^ propagate, as carries of one addition of bit masks
+// It is faster than chain of ADC only with AVX-512, which has unsigned comparisons to masks and masked addition,
+// other x86-64 processors add by ADC
+namespace LongMath::kernels {
+    namespace {
+        // Arrays shorter than this take portable loop, vector setup does not pay for them
+        const size_t SIMD_MIN_LENGTH = 8;
+
+        enum class Logic {
+            AND,
+            IOR,
+            XOR
+        };
+
+        template <Logic op>
+        limb apply(limb x, limb y) {
+            if constexpr (op == Logic::AND) {
+                return x & y;
+            } else if constexpr (op == Logic::IOR) {
+                return x | y;
+            } else {
+                return x ^ y;
+            }
+        }
+
+        int cmpGeneric(const limb *a, const limb *b, size_t n) {
+            for (size_t i = n; i > 0; i--) {
+                if (a[i - 1] != b[i - 1]) {
+                    return a[i - 1] > b[i - 1] ? 1 : -1;
+                }
+            }
+            return 0;
+        }
+
+        limb addGeneric(limb *r, const limb *a, const limb *b, size_t n, limb carry) {
+            for (size_t i = 0; i < n; i++) {
+                const dlimb sum = dlimb(a[i]) + b[i] + carry;
+                r[i]  = limb(sum);
+                carry = limb(sum >> LIMB_WIDTH);
+            }
+            return carry;
+        }
+
+        limb subGeneric(limb *r, const limb *a, const limb *b, size_t n, limb borrow) {
+            for (size_t i = 0; i < n; i++) {
+                const limb x = a[i];
+                const limb y = b[i] + borrow;
+                // b[i] + borrow overflows only if b[i] == LIMB_MAX and borrow == 1
+                borrow = (y < borrow) | (x < y);
+                r[i]   = x - y;
+            }
+            return borrow;
+        }
+
+        limb mul1Generic(limb *r, const limb *a, size_t n, limb b, limb carry) {
+            for (size_t i = 0; i < n; i++) {
+                const dlimb product = dlimb(a[i]) * b + carry;
+                r[i]  = limb(product);
+                carry = limb(product >> LIMB_WIDTH);
+            }
+            return carry;
+        }
+
+        limb addmul1Generic(limb *r, const limb *a, size_t n, limb b, limb carry) {
+            for (size_t i = 0; i < n; i++) {
+                const dlimb product = dlimb(a[i]) * b + r[i] + carry;
+                r[i]  = limb(product);
+                carry = limb(product >> LIMB_WIDTH);
+            }
+            return carry;
+        }
+
+        limb submul1Generic(limb *r, const limb *a, size_t n, limb b, limb borrow) {
+            for (size_t i = 0; i < n; i++) {
+                const dlimb product = dlimb(a[i]) * b + borrow;
+                const limb  low     = limb(product);
+                borrow = limb(product >> LIMB_WIDTH) + (r[i] < low);
+                r[i]  -= low;
+            }
+            return borrow;
+        }
+
+        template <Logic op>
+        void bitwiseGeneric(limb *r, const limb *a, const limb *b, size_t n, Complements masks) {
+            for (size_t i = 0; i < n; i++) {
+                r[i] = apply<op>(a[i] ^ masks.a, b[i] ^ masks.b) ^ masks.r;
+            }
+        }
+
+#if defined(__x86_64__)
+        // Instruction sets are checked once
+        struct Cpu {
+            bool avx2;
+            bool avx512;
+            bool mulx;      // BMI2 and ADX
+        };
+
+        const Cpu &cpu() {
+            static const Cpu forRet{__builtin_cpu_supports("avx2") != 0,
+                                    __builtin_cpu_supports("avx512f") != 0,
+                                    __builtin_cpu_supports("bmi2") != 0 && __builtin_cpu_supports("adx") != 0};
+            return forRet;
+        }
+
+        // Assembler kernels take n limbs, which is multiple of 4, n > 0
+        // Limbs are indexed from end of arrays by negative counter in rcx, so loop is closed by lea and jrcxz,
+        // which do not change flags, and carries stay in flags between blocks
+        // Rest of limbs goes to portable loop with carry, which is returned
+
+        // MULX does not change flags, so products are joined by one chain of ADCX
+        limb mul1Mulx(limb *r, const limb *a, size_t n, limb b) {
+            limb carry = 0;
+            limb low;
+            limb high;
+            long i = -long(n);
+            asm volatile(
+                    "xor %k[low], %k[low]\n\t"
+                    "1:\n\t"
+                    "mulx (%[a],%[i],8), %[low], %[high]\n\t"
+                    "adcx %[carry], %[low]\n\t"
+                    "mov %[low], (%[r],%[i],8)\n\t"
+                    "mulx 8(%[a],%[i],8), %[low], %[carry]\n\t"
+                    "adcx %[high], %[low]\n\t"
+                    "mov %[low], 8(%[r],%[i],8)\n\t"
+                    "mulx 16(%[a],%[i],8), %[low], %[high]\n\t"
+                    "adcx %[carry], %[low]\n\t"
+                    "mov %[low], 16(%[r],%[i],8)\n\t"
+                    "mulx 24(%[a],%[i],8), %[low], %[carry]\n\t"
+                    "adcx %[high], %[low]\n\t"
+                    "mov %[low], 24(%[r],%[i],8)\n\t"
+                    "lea 4(%[i]), %[i]\n\t"
+                    "jrcxz 2f\n\t"
+                    "jmp 1b\n\t"
+                    "2:\n\t"
+                    "mov $0, %k[low]\n\t"
+                    "adcx %[low], %[carry]\n\t"
+                    : [carry] "+&r"(carry), [low] "=&r"(low), [high] "=&r"(high), [i] "+&c"(i)
+                    : [a] "r"(a + n), [r] "r"(r + n), "d"(b)
+                    : "cc", "memory");
+            return carry;
+        }
+
+        // Two chains of carries: ADCX adds high limb of previous product, ADOX adds limb of r
+        // Both carries come to next limb, so they are added to last high limb at the end
+        limb addmul1Mulx(limb *r, const limb *a, size_t n, limb b) {
+            limb carry = 0;
+            limb low;
+            limb high;
+            long i = -long(n);
+            asm volatile(
+                    "xor %k[low], %k[low]\n\t"
+                    "1:\n\t"
+                    "mulx (%[a],%[i],8), %[low], %[high]\n\t"
+                    "adcx %[carry], %[low]\n\t"
+                    "adox (%[r],%[i],8), %[low]\n\t"
+                    "mov %[low], (%[r],%[i],8)\n\t"
+                    "mulx 8(%[a],%[i],8), %[low], %[carry]\n\t"
+                    "adcx %[high], %[low]\n\t"
+                    "adox 8(%[r],%[i],8), %[low]\n\t"
+                    "mov %[low], 8(%[r],%[i],8)\n\t"
+                    "mulx 16(%[a],%[i],8), %[low], %[high]\n\t"
+                    "adcx %[carry], %[low]\n\t"
+                    "adox 16(%[r],%[i],8), %[low]\n\t"
+                    "mov %[low], 16(%[r],%[i],8)\n\t"
+                    "mulx 24(%[a],%[i],8), %[low], %[carry]\n\t"
+                    "adcx %[high], %[low]\n\t"
+                    "adox 24(%[r],%[i],8), %[low]\n\t"
+                    "mov %[low], 24(%[r],%[i],8)\n\t"
+                    "lea 4(%[i]), %[i]\n\t"
+                    "jrcxz 2f\n\t"
+                    "jmp 1b\n\t"
+                    "2:\n\t"
+                    "mov $0, %k[low]\n\t"
+                    "adcx %[low], %[carry]\n\t"
+                    "adox %[low], %[carry]\n\t"
+                    : [carry] "+&r"(carry), [low] "=&r"(low), [high] "=&r"(high), [i] "+&c"(i)
+                    : [a] "r"(a + n), [r] "r"(r + n), "d"(b)
+                    : "cc", "memory");
+            return carry;
+        }
+
+        // r - t = r + ~t + 1 for limbs t of product: ADOX joins products, ADCX adds complements with CF = 1 first,
+        // so there is no borrow where CF is 1 at the end
+        limb submul1Mulx(limb *r, const limb *a, size_t n, limb b) {
+            limb carry = 0;
+            limb low;
+            limb high;
+            long i = -long(n);
+            asm volatile(
+                    "xor %k[low], %k[low]\n\t"
+                    "stc\n\t"
+                    "1:\n\t"
+                    "mulx (%[a],%[i],8), %[low], %[high]\n\t"
+                    "adox %[carry], %[low]\n\t"
+                    "not %[low]\n\t"
+                    "adcx (%[r],%[i],8), %[low]\n\t"
+                    "mov %[low], (%[r],%[i],8)\n\t"
+                    "mulx 8(%[a],%[i],8), %[low], %[carry]\n\t"
+                    "adox %[high], %[low]\n\t"
+                    "not %[low]\n\t"
+                    "adcx 8(%[r],%[i],8), %[low]\n\t"
+                    "mov %[low], 8(%[r],%[i],8)\n\t"
+                    "mulx 16(%[a],%[i],8), %[low], %[high]\n\t"
+                    "adox %[carry], %[low]\n\t"
+                    "not %[low]\n\t"
+                    "adcx 16(%[r],%[i],8), %[low]\n\t"
+                    "mov %[low], 16(%[r],%[i],8)\n\t"
+                    "mulx 24(%[a],%[i],8), %[low], %[carry]\n\t"
+                    "adox %[high], %[low]\n\t"
+                    "not %[low]\n\t"
+                    "adcx 24(%[r],%[i],8), %[low]\n\t"
+                    "mov %[low], 24(%[r],%[i],8)\n\t"
+                    "lea 4(%[i]), %[i]\n\t"
+                    "jrcxz 2f\n\t"
+                    "jmp 1b\n\t"
+                    "2:\n\t"
+                    "mov $0, %k[low]\n\t"
+                    "adox %[low], %[carry]\n\t"
+                    "cmc\n\t"
+                    "adc %[low], %[carry]\n\t"
+                    : [carry] "+&r"(carry), [low] "=&r"(low), [high] "=&r"(high), [i] "+&c"(i)
+                    : [a] "r"(a + n), [r] "r"(r + n), "d"(b)
+                    : "cc", "memory");
+            return carry;
+        }
+
+        // Addition and subtraction by one chain of ADC and SBB
+        limb addAdc(limb *r, const limb *a, const limb *b, size_t n) {
+            limb carry = 0;
+            limb t;
+            long i = -long(n);
+            asm volatile(
+                    "clc\n\t"
+                    "1:\n\t"
+                    "mov (%[a],%[i],8), %[t]\n\t"
+                    "adc (%[b],%[i],8), %[t]\n\t"
+                    "mov %[t], (%[r],%[i],8)\n\t"
+                    "mov 8(%[a],%[i],8), %[t]\n\t"
+                    "adc 8(%[b],%[i],8), %[t]\n\t"
+                    "mov %[t], 8(%[r],%[i],8)\n\t"
+                    "mov 16(%[a],%[i],8), %[t]\n\t"
+                    "adc 16(%[b],%[i],8), %[t]\n\t"
+                    "mov %[t], 16(%[r],%[i],8)\n\t"
+                    "mov 24(%[a],%[i],8), %[t]\n\t"
+                    "adc 24(%[b],%[i],8), %[t]\n\t"
+                    "mov %[t], 24(%[r],%[i],8)\n\t"
+                    "lea 4(%[i]), %[i]\n\t"
+                    "jrcxz 2f\n\t"
+                    "jmp 1b\n\t"
+                    "2:\n\t"
+                    "adc $0, %[carry]\n\t"
+                    : [carry] "+&r"(carry), [t] "=&r"(t), [i] "+&c"(i)
+                    : [a] "r"(a + n), [b] "r"(b + n), [r] "r"(r + n)
+                    : "cc", "memory");
+            return carry;
+        }
+
+        limb subSbb(limb *r, const limb *a, const limb *b, size_t n) {
+            limb borrow = 0;
+            limb t;
+            long i = -long(n);
+            asm volatile(
+                    "clc\n\t"
+                    "1:\n\t"
+                    "mov (%[a],%[i],8), %[t]\n\t"
+                    "sbb (%[b],%[i],8), %[t]\n\t"
+                    "mov %[t], (%[r],%[i],8)\n\t"
+                    "mov 8(%[a],%[i],8), %[t]\n\t"
+                    "sbb 8(%[b],%[i],8), %[t]\n\t"
+                    "mov %[t], 8(%[r],%[i],8)\n\t"
+                    "mov 16(%[a],%[i],8), %[t]\n\t"
+                    "sbb 16(%[b],%[i],8), %[t]\n\t"
+                    "mov %[t], 16(%[r],%[i],8)\n\t"
+                    "mov 24(%[a],%[i],8), %[t]\n\t"
+                    "sbb 24(%[b],%[i],8), %[t]\n\t"
+                    "mov %[t], 24(%[r],%[i],8)\n\t"
+                    "lea 4(%[i]), %[i]\n\t"
+                    "jrcxz 2f\n\t"
+                    "jmp 1b\n\t"
+                    "2:\n\t"
+                    "adc $0, %[borrow]\n\t"
+                    : [borrow] "+&r"(borrow), [t] "=&r"(t), [i] "+&c"(i)
+                    : [a] "r"(a + n), [b] "r"(b + n), [r] "r"(r + n)
+                    : "cc", "memory");
+            return borrow;
+        }
+
+        __attribute__((target("avx2")))
+        __m256i load4(const limb *a) {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));
+        }
+
+        __attribute__((target("avx2")))
+        void store4(limb *r, __m256i x) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(r), x);
+        }
+
+        __attribute__((target("avx2")))
+        unsigned laneBits(__m256i mask) {
+            return unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+        }
+
+        // Lanes are compared from higher ones, first different lane is compared as numbers
+        __attribute__((target("avx2")))
+        int cmpAvx2(const limb *a, const limb *b, size_t n) {
+            size_t i = n;
+            for (; i >= 4; i -= 4) {
+                const unsigned equal = laneBits(_mm256_cmpeq_epi64(load4(a + i - 4), load4(b + i - 4)));
+                if (equal != 0xf) {
+                    const size_t j = i - 4 + 31 - __builtin_clz(~equal & 0xf);
+                    return a[j] > b[j] ? 1 : -1;
+                }
+            }
+            return cmpGeneric(a, b, i);
+        }
+
+        template <Logic op>
+        __attribute__((target("avx2")))
+        __m256i apply4(__m256i x, __m256i y) {
+            if constexpr (op == Logic::AND) {
+                return _mm256_and_si256(x, y);
+            } else if constexpr (op == Logic::IOR) {
+                return _mm256_or_si256(x, y);
+            } else {
+                return _mm256_xor_si256(x, y);
+            }
+        }
+
+        template <Logic op>
+        __attribute__((target("avx2")))
+        void bitwiseAvx2(limb *r, const limb *a, const limb *b, size_t n, Complements masks) {
+            const __m256i ma = _mm256_set1_epi64x(std::int64_t(masks.a));
+            const __m256i mb = _mm256_set1_epi64x(std::int64_t(masks.b));
+            const __m256i mr = _mm256_set1_epi64x(std::int64_t(masks.r));
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                const __m256i x = _mm256_xor_si256(load4(a + i), ma);
+                const __m256i y = _mm256_xor_si256(load4(b + i), mb);
+                store4(r + i, _mm256_xor_si256(apply4<op>(x, y), mr));
+            }
+            bitwiseGeneric<op>(r + i, a + i, b + i, n - i, masks);
+        }
+
+        // AVX-512 has unsigned comparisons to lane masks and masked addition, so carries take no tables
+        __attribute__((target("avx512f")))
+        int cmpAvx512(const limb *a, const limb *b, size_t n) {
+            size_t i = n;
+            for (; i >= 8; i -= 8) {
+                const unsigned different = _mm512_cmpneq_epu64_mask(_mm512_loadu_si512(a + i - 8),
+                                                                     _mm512_loadu_si512(b + i - 8));
+                if (different) {
+                    const size_t j = i - 8 + 31 - __builtin_clz(different);
+                    return a[j] > b[j] ? 1 : -1;
+                }
+            }
+            return cmpGeneric(a, b, i);
+        }
+
+        __attribute__((target("avx512f")))
+        limb addAvx512(limb *r, const limb *a, const limb *b, size_t n) {
+            const __m512i ones = _mm512_set1_epi64(-1);
+            unsigned carry = 0;
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                const __m512i x   = _mm512_loadu_si512(a + i);
+                const __m512i sum = _mm512_add_epi64(x, _mm512_loadu_si512(b + i));
+                const unsigned generate  = _mm512_cmplt_epu64_mask(sum, x);
+                const unsigned propagate = _mm512_cmpeq_epu64_mask(sum, ones);
+                const unsigned incoming  = (generate << 1 | carry) + propagate;
+                carry = incoming >> 8;
+                _mm512_storeu_si512(r + i, _mm512_mask_sub_epi64(sum, __mmask8(incoming ^ propagate), sum, ones));
+            }
+            return addGeneric(r + i, a + i, b + i, n - i, carry);
+        }
+
+        __attribute__((target("avx512f")))
+        limb subAvx512(limb *r, const limb *a, const limb *b, size_t n) {
+            const __m512i ones = _mm512_set1_epi64(-1);
+            unsigned borrow = 0;
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                const __m512i x = _mm512_loadu_si512(a + i);
+                const __m512i y = _mm512_loadu_si512(b + i);
+                const __m512i difference = _mm512_sub_epi64(x, y);
+                const unsigned generate  = _mm512_cmplt_epu64_mask(x, y);
+                const unsigned propagate = _mm512_cmpeq_epu64_mask(difference, _mm512_setzero_si512());
+                const unsigned incoming  = (generate << 1 | borrow) + propagate;
+                borrow = incoming >> 8;
+                _mm512_storeu_si512(r + i, _mm512_mask_add_epi64(difference, __mmask8(incoming ^ propagate),
+                                                                 difference, ones));
+            }
+            return subGeneric(r + i, a + i, b + i, n - i, borrow);
+        }
+
+        template <Logic op>
+        __attribute__((target("avx512f")))
+        __m512i apply8(__m512i x, __m512i y) {
+            if constexpr (op == Logic::AND) {
+                return _mm512_and_si512(x, y);
+            } else if constexpr (op == Logic::IOR) {
+                return _mm512_or_si512(x, y);
+            } else {
+                return _mm512_xor_si512(x, y);
+            }
+        }
+
+        template <Logic op>
+        __attribute__((target("avx512f")))
+        void bitwiseAvx512(limb *r, const limb *a, const limb *b, size_t n, Complements masks) {
+            const __m512i ma = _mm512_set1_epi64(std::int64_t(masks.a));
+            const __m512i mb = _mm512_set1_epi64(std::int64_t(masks.b));
+            const __m512i mr = _mm512_set1_epi64(std::int64_t(masks.r));
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                const __m512i x = _mm512_xor_si512(_mm512_loadu_si512(a + i), ma);
+                const __m512i y = _mm512_xor_si512(_mm512_loadu_si512(b + i), mb);
+                _mm512_storeu_si512(r + i, _mm512_xor_si512(apply8<op>(x, y), mr));
+            }
+            bitwiseGeneric<op>(r + i, a + i, b + i, n - i, masks);
+        }
+#endif
+
+        template <Logic op>
+        void bitwise(limb *r, const limb *a, const limb *b, size_t n, Complements masks) {
+#if defined(__x86_64__)
+            if (SIMD_KERNELS && n >= SIMD_MIN_LENGTH) {
+                if (cpu().avx512) {
+                    bitwiseAvx512<op>(r, a, b, n, masks);
+                    return;
+                }
+                if (cpu().avx2) {
+                    bitwiseAvx2<op>(r, a, b, n, masks);
+                    return;
+                }
+            }
+#endif
+            bitwiseGeneric<op>(r, a, b, n, masks);
+        }
+    }
+
+    int cmp(const limb *a, const limb *b, size_t n) {
+#if defined(__x86_64__)
+        if (SIMD_KERNELS && n >= SIMD_MIN_LENGTH) {
+            if (cpu().avx512) {
+                return cmpAvx512(a, b, n);
+            }
+            if (cpu().avx2) {
+                return cmpAvx2(a, b, n);
+            }
+        }
+#endif
+        return cmpGeneric(a, b, n);
+    }
+
+    limb add_n(limb *r, const limb *a, const limb *b, size_t n) {
+        size_t done = 0;
+        limb carry  = 0;
+#if defined(__x86_64__)
+        if (SIMD_KERNELS && n >= SIMD_MIN_LENGTH) {
+            if (cpu().avx512) {
+                return addAvx512(r, a, b, n);
+            }
+            done  = n & ~size_t(3);
+            carry = addAdc(r, a, b, done);
+        }
+#endif
+        return addGeneric(r + done, a + done, b + done, n - done, carry);
+    }
+
+    limb sub_n(limb *r, const limb *a, const limb *b, size_t n) {
+        size_t done = 0;
+        limb borrow = 0;
+#if defined(__x86_64__)
+        if (SIMD_KERNELS && n >= SIMD_MIN_LENGTH) {
+            if (cpu().avx512) {
+                return subAvx512(r, a, b, n);
+            }
+            done   = n & ~size_t(3);
+            borrow = subSbb(r, a, b, done);
+        }
+#endif
+        return subGeneric(r + done, a + done, b + done, n - done, borrow);
+    }
+
+    void and_n(limb *r, const limb *a, const limb *b, size_t n, Complements masks) {
+        bitwise<Logic::AND>(r, a, b, n, masks);
+    }
+
+    void ior_n(limb *r, const limb *a, const limb *b, size_t n, Complements masks) {
+        bitwise<Logic::IOR>(r, a, b, n, masks);
+    }
+
+    void xor_n(limb *r, const limb *a, const limb *b, size_t n, Complements masks) {
+        bitwise<Logic::XOR>(r, a, b, n, masks);
+    }
+
+    limb mul_1(limb *r, const limb *a, size_t n, limb b) {
+        size_t done = 0;
+        limb carry  = 0;
+#if defined(__x86_64__)
+        if (SIMD_KERNELS && n >= SIMD_MIN_LENGTH && cpu().mulx) {
+            done  = n & ~size_t(3);
+            carry = mul1Mulx(r, a, done, b);
+        }
+#endif
+        return mul1Generic(r + done, a + done, n - done, b, carry);
+    }
+
+    limb addmul_1(limb *r, const limb *a, size_t n, limb b) {
+        size_t done = 0;
+        limb carry  = 0;
+#if defined(__x86_64__)
+        if (SIMD_KERNELS && n >= SIMD_MIN_LENGTH && cpu().mulx) {
+            done  = n & ~size_t(3);
+            carry = addmul1Mulx(r, a, done, b);
+        }
+#endif
+        return addmul1Generic(r + done, a + done, n - done, b, carry);
+    }
+
+    limb submul_1(limb *r, const limb *a, size_t n, limb b) {
+        size_t done = 0;
+        limb borrow = 0;
+#if defined(__x86_64__)
+        if (SIMD_KERNELS && n >= SIMD_MIN_LENGTH && cpu().mulx) {
+            done   = n & ~size_t(3);
+            borrow = submul1Mulx(r, a, done, b);
+        }
+#endif
+        return submul1Generic(r + done, a + done, n - done, b, borrow);
+    }
+}
@@ -1,6 +1,14 @@
 #include "BigInt.h"
+#include "Modular.h"
+#include "Roots.h"
+#include "Combinatorics.h"
+#include "FixedInt.h"
 #include "gtest/gtest.h"
 
+#ifndef sstream
+#include <sstream>
+#endif
+
 using namespace LongMath;
 
 
@@ -8,7 +16,7 @@ using namespace LongMath;
 TEST(Constructors, DefaultConstructor)
 {
     BigInt x;
-    EXPECT_TRUE (x.getArray().empty());
+    EXPECT_TRUE (x.getBytes().empty());
     EXPECT_FALSE(x.lessZero());
 }
 
@@ -17,96 +25,131 @@ TEST(ManipulatingWithRadixes, AddRadix)
     {
         BigInt num(std::vector<uchar>{0});
         num.addRadix();
-        EXPECT_EQ(std::vector<uchar>({0, 0}), num.getArray());
+        EXPECT_EQ(std::vector<limb>({0, 0}), num.getArray());
     }
     {
         BigInt num(std::vector<uchar>{255, 0});
         num.addRadix();
-        EXPECT_EQ(std::vector<uchar>({255, 0, 0}), num.getArray());
+        EXPECT_EQ(std::vector<limb>({255, 0}), num.getArray());
     }
     {
         BigInt num(std::vector<uchar>{0, 1});
         num.addRadix();
-        EXPECT_EQ(std::vector<uchar>({0, 1, 0}), num.getArray());
+        EXPECT_EQ(std::vector<limb>({256, 0}), num.getArray());
     }
     {
         BigInt num(std::vector<uchar>{1, 1});
         num.addRadix();
-        EXPECT_EQ(std::vector<uchar>({1, 1, 0}), num.getArray());
+        EXPECT_EQ(std::vector<limb>({257, 0}), num.getArray());
     }
     {
         BigInt num(std::vector<uchar>{255});
         num.addRadix();
-        EXPECT_EQ(std::vector<uchar>({255, 255}), num.getArray());
+        EXPECT_EQ(std::vector<limb>({LIMB_MAX, LIMB_MAX}), num.getArray());
     }
     {
         BigInt num(std::vector<uchar>{0, 250});
         num.addRadix();
-        EXPECT_EQ(std::vector<uchar>({0, 250, 255}), num.getArray());
+        EXPECT_EQ(std::vector<limb>({LIMB_MAX - 0x5FF, LIMB_MAX}), num.getArray());
+    }
+    {
+        BigInt num(std::vector<uchar>{255, 250});
+        num.addRadix();
+        EXPECT_EQ(std::vector<limb>({LIMB_MAX - 0x500, LIMB_MAX}), num.getArray());
     }
     {
         BigInt num(std::vector<uchar>{255, 250});
         num.addRadix();
-        EXPECT_EQ(std::vector<uchar>({255, 250, 255}), num.getArray());
+        EXPECT_EQ(std::vector<uchar>({255, 250}), num.getBytes());
     }
 }
 
+TEST(LimbArrays, InlineAndHeap)
+{
+    LimbArray a{1, 2};
+    EXPECT_EQ(a.capacity(), LimbArray::INLINE_CAPACITY);
+    a.push_back(3);
+    EXPECT_GE(a.capacity(), 3);
+    EXPECT_EQ(a, LimbArray({1, 2, 3}));
+
+    // Heap array is taken by move, inline buffer is copied
+    LimbArray b(std::move(a));
+    EXPECT_EQ(b, LimbArray({1, 2, 3}));
+    EXPECT_TRUE(a.empty());
+    LimbArray c{4};
+    LimbArray d(std::move(c));
+    EXPECT_EQ(d, LimbArray({4}));
+
+    d = b;
+    b.resize(1);
+    EXPECT_EQ(d, LimbArray({1, 2, 3}));
+    EXPECT_EQ(b, LimbArray({1}));
+    d = std::move(b);
+    EXPECT_EQ(d, LimbArray({1}));
+    d.resize(5, LIMB_MAX);
+    EXPECT_EQ(d, LimbArray({1, LIMB_MAX, LIMB_MAX, LIMB_MAX, LIMB_MAX}));
+
+    BigInt x(std::string(100, '9'));
+    x = BigInt(5);
+    EXPECT_EQ(x + x, DEC);
+}
+
 TEST(ManipulatingWithRadixes, PurgeRadix)
 {
     {
         BigInt num(std::vector<uchar>{0});
         num.purgeRadix();
-        EXPECT_EQ(std::vector<uchar>({0}), num.getArray());
+        EXPECT_EQ(std::vector<uchar>({0}), num.getBytes());
     }
     {
         BigInt num(std::vector<uchar>{100});
         num.purgeRadix();
-        EXPECT_EQ(std::vector<uchar>({100}), num.getArray());
+        EXPECT_EQ(std::vector<uchar>({100}), num.getBytes());
     }
     {
         BigInt num(std::vector<uchar>{240});
         num.purgeRadix();
-        EXPECT_EQ(std::vector<uchar>({240}), num.getArray());
+        EXPECT_EQ(std::vector<uchar>({240}), num.getBytes());
     }
     {
         BigInt num(std::vector<uchar>{100, 100});
         num.purgeRadix();
-        EXPECT_EQ(std::vector<uchar>({100, 100}), num.getArray());
+        EXPECT_EQ(std::vector<uchar>({100, 100}), num.getBytes());
     }
     {
         BigInt num(std::vector<uchar>{0, 100});
         num.purgeRadix();
-        EXPECT_EQ(std::vector<uchar>({0, 100}), num.getArray());
+        EXPECT_EQ(std::vector<uchar>({0, 100}), num.getBytes());
     }
     {
         BigInt num(std::vector<uchar>{100, 250});
         num.purgeRadix();
-        EXPECT_EQ(std::vector<uchar>({100, 250}), num.getArray());
+        EXPECT_EQ(std::vector<uchar>({100, 250}), num.getBytes());
     }
     {
         BigInt num(std::vector<uchar>{0, 250});
         num.purgeRadix();
-        EXPECT_EQ(std::vector<uchar>({0, 250}), num.getArray());
+        EXPECT_EQ(std::vector<uchar>({0, 250}), num.getBytes());
     }
     {
         BigInt num(std::vector<uchar>{100, 0});
         num.purgeRadix();
-        EXPECT_EQ(std::vector<uchar>({100}), num.getArray());
+        EXPECT_EQ(std::vector<uchar>({100}), num.getBytes());
     }
     {
         BigInt num(std::vector<uchar>{100, 0, 0, 0, 0});
         num.purgeRadix();
-        EXPECT_EQ(std::vector<uchar>({100}), num.getArray());
+        EXPECT_EQ(std::vector<uchar>({100}), num.getBytes());
     }
     {
         BigInt num(std::vector<uchar>{100, 255});
         num.purgeRadix();
-        EXPECT_EQ(std::vector<uchar>({100}), num.getArray());
+        EXPECT_EQ(std::vector<uchar>({100}), num.getBytes());
     }
     {
         BigInt num(std::vector<uchar>{100, 255, 255, 255, 255});
         num.purgeRadix();
-        EXPECT_EQ(std::vector<uchar>({100}), num.getArray());
+        EXPECT_EQ(std::vector<uchar>({100}), num.getBytes());
     }
 }
 
@@ -118,7 +161,7 @@ TEST(Constructors, IntConstructor)
         {
             int compare = static_cast<int>(i + k - 1);
             {
-                std::vector<uchar> num = BigInt(compare).getArray();
+                std::vector<uchar> num = BigInt(compare).getBytes();
                 unsigned int buf = 0;
                 for (size_t j = 0; j < sizeof(int); j++) {
                     buf = buf * 256 + (sizeof(int) - j - 1 < num.size() ? num[sizeof(int) - 1 - j] : 0);
@@ -129,7 +172,7 @@ TEST(Constructors, IntConstructor)
             {
                 if (compare)
                 {
-                    std::vector<uchar> num = BigInt(compare).getArray();
+                    std::vector<uchar> num = BigInt(compare).getBytes();
                     unsigned int buf = 0;
                     for (size_t j = 0; j < sizeof(int); j++) {
                         buf = buf * 256 + (sizeof(int) - j - 1 < num.size() ? num[sizeof(int) - 1 - j] : UINT8_MAX);
@@ -141,6 +184,74 @@ TEST(Constructors, IntConstructor)
     }
 }
 
+// Resource, which counts allocated bytes and gives memory from upstream resource
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocated = 0;
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        allocated += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+        allocated -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+};
+
+TEST(Constructors, MemoryResource)
+{
+    CountingResource counter;
+    {
+        const BigInt a(std::string(100, '9'), &counter);
+        EXPECT_EQ(a.resource(), &counter);
+        EXPECT_GT(counter.allocated, 0);
+
+        // Results take memory from resource of left operand
+        const BigInt b(a * a + a - BigInt(7));
+        EXPECT_EQ(b.resource(), &counter);
+        EXPECT_EQ(divmod(b, a).first.resource(), &counter);
+        EXPECT_EQ(b / a, a);
+
+        // Copies and results of lvalue operands stay in resource too
+        EXPECT_EQ(BigInt(a).resource(), &counter);
+        EXPECT_EQ((a + b).resource(), &counter);
+        EXPECT_EQ((a - b).resource(), &counter);
+        EXPECT_EQ((a ^ b).resource(), &counter);
+        EXPECT_EQ((-a).resource(), &counter);
+        EXPECT_EQ((a << 100).resource(), &counter);
+        EXPECT_EQ((a >> 100).resource(), &counter);
+
+        // Number is copied out of resource
+        BigInt c(b, std::pmr::get_default_resource());
+        EXPECT_EQ(c.resource(), std::pmr::get_default_resource());
+        EXPECT_EQ(c, b);
+        c = BigInt(a);
+        EXPECT_EQ(c.resource(), std::pmr::get_default_resource());
+        EXPECT_EQ(c, a);
+
+        // Small numbers do not allocate
+        const size_t before = counter.allocated;
+        const BigInt d(-5, &counter);
+        EXPECT_EQ(counter.allocated, before);
+        EXPECT_EQ(d, BigInt(-5));
+    }
+    EXPECT_EQ(counter.allocated, 0);
+
+    std::pmr::monotonic_buffer_resource arena;
+    BigInt sum(&arena);
+    for (int i = 0; i < 100; i++) {
+        sum += BigInt(std::string(50, '1'), &arena) * BigInt(i);
+    }
+    EXPECT_EQ(sum, BigInt(std::string(50, '1')) * BigInt(4950));
+}
+
 TEST(Assignments, CopyAssignment)
 {
     BigInt a;
@@ -422,6 +533,79 @@ TEST(Operators, Mul)
     }
 }
 
+TEST(Operators, MulMultiLimb)
+{
+    const BigInt a(std::to_string(UINT64_MAX));
+    EXPECT_EQ(std::string(a * a), "340282366920938463426481119284349108225");
+    EXPECT_EQ(std::string(a * -a), "-340282366920938463426481119284349108225");
+    EXPECT_EQ(std::string(BigInt("-18446744073709551616") * BigInt("18446744073709551616")),
+              "-340282366920938463463374607431768211456");
+}
+
+TEST(Operators, MulKaratsubaToom3)
+{
+    // (10^600 - 1)^2 = 10^1200 - 2 * 10^600 + 1
+    const BigInt a(std::string(600, '9'));
+    const BigInt b(-a + BigInt(7));
+    const std::string expected(std::string(599, '9') + "8" + std::string(599, '0') + "1");
+
+    const size_t karatsuba = KARATSUBA_THRESHOLD;
+    const size_t square    = KARATSUBA_SQR_THRESHOLD;
+    const size_t toom3     = TOOM3_THRESHOLD;
+    const BigInt basecase(a * b);
+    for (const auto &[k, t] : {std::pair<size_t, size_t>{2, 1000}, {4, 8}, {2, 3}, {5, 17}}) {
+        KARATSUBA_THRESHOLD     = k;
+        KARATSUBA_SQR_THRESHOLD = k + 1;
+        TOOM3_THRESHOLD         = t;
+        EXPECT_EQ(std::string(a * a), expected);
+        EXPECT_EQ(a * b, basecase);
+        EXPECT_EQ(a * BigInt(std::string(250, '7')), BigInt(std::string(250, '7')) * a);
+    }
+    KARATSUBA_THRESHOLD     = karatsuba;
+    KARATSUBA_SQR_THRESHOLD = square;
+    TOOM3_THRESHOLD         = toom3;
+}
+
+TEST(Operators, MulNtt)
+{
+    // (10^3000 - 1)^2 = 10^6000 - 2 * 10^3000 + 1
+    const BigInt a(std::string(3000, '9'));
+    const BigInt b(std::string(1000, '3'));
+    const std::string expected(std::string(2999, '9') + "8" + std::string(2999, '0') + "1");
+
+    const size_t ntt = NTT_THRESHOLD;
+    const BigInt toom3(a * -b);
+    for (size_t n : {1, 7, 64}) {
+        NTT_THRESHOLD = n;
+        EXPECT_EQ(std::string(a * a), expected);
+        EXPECT_EQ(a * -b, toom3);
+        EXPECT_EQ(-b * a, toom3);
+    }
+    NTT_THRESHOLD = ntt;
+}
+
+TEST(Operators, Temporaries)
+{
+    const BigInt a(std::string(40, '7'));
+    const BigInt b("-" + std::string(30, '3'));
+    const BigInt c(std::to_string(UINT64_MAX));
+
+    EXPECT_EQ(a * b + c * a - b, BigInt(a) * b + BigInt(c) * a - b);
+    EXPECT_EQ(a - (b - c), a - b + c);
+    EXPECT_EQ((a - b) - (b - c), a + c - b - b);
+    EXPECT_EQ(-(a + b), -a - b);
+    EXPECT_EQ(a ^ (b | c), (b | c) ^ a);
+    EXPECT_EQ((a & c) | (b & c), (a | b) & c);
+    EXPECT_EQ(-BigInt(INT32_MIN) - ONE, BigInt(INT32_MAX));
+
+    BigInt x(a);
+    x -= x;
+    EXPECT_EQ(x, ZERO);
+    x = c;
+    x *= x;
+    EXPECT_EQ(x, c * c);
+}
+
 TEST(Operators, Add)
 {
     {
@@ -620,6 +804,63 @@ TEST(Constructors, StringConstructor)
     EXPECT_THROW(BigInt("+!487"),    std::invalid_argument);
 }
 
+TEST(Conversions, FromString)
+{
+    EXPECT_EQ(BigInt("9999999999999999999"), BigInt("10000000000000000000") - ONE);
+    EXPECT_EQ(BigInt("-18446744073709551616"), -BigInt(std::to_string(UINT64_MAX)) - ONE);
+    EXPECT_EQ(BigInt("0000000000000000000000000000000000000018446744073709551615"),
+              BigInt(std::to_string(UINT64_MAX)));
+
+    std::string digits;
+    for (size_t i = 0; i < 300; i++) {
+        digits += "9876543210";
+    }
+    const BigInt power(DEC * BigInt("1" + std::string(1999, '0')));
+
+    const size_t conversion = RADIX_CONVERSION_THRESHOLD;
+    BigInt expected(ZERO);
+    for (char c : digits) {
+        expected = expected * DEC + BigInt(c - '0');
+    }
+    for (size_t c : {2, 3, 7, 32}) {
+        RADIX_CONVERSION_THRESHOLD = c;
+        EXPECT_EQ(BigInt(digits), expected);
+        EXPECT_EQ(BigInt("-" + digits), -expected);
+        EXPECT_EQ(BigInt("1" + std::string(2000, '0')), power);
+        EXPECT_EQ(BigInt(std::string(2000, '9')), power - ONE);
+        EXPECT_THROW(BigInt(digits + "a" + digits), std::invalid_argument);
+    }
+    RADIX_CONVERSION_THRESHOLD = conversion;
+}
+
+TEST(Conversions, ToString)
+{
+    EXPECT_EQ(std::string(ZERO), "0");
+    EXPECT_EQ(std::string(BigInt(-1)), "-1");
+    EXPECT_EQ(std::string(BigInt(INT32_MIN)), std::to_string(INT32_MIN));
+    EXPECT_EQ(std::string(BigInt(std::to_string(UINT64_MAX))), std::to_string(UINT64_MAX));
+    EXPECT_EQ(std::string(BigInt("10000000000000000000")), "10000000000000000000");
+
+    std::string digits;
+    for (size_t i = 0; i < 300; i++) {
+        digits += "1234567890";
+    }
+    const std::string power("1" + std::string(2000, '0'));
+
+    const size_t conversion = RADIX_CONVERSION_THRESHOLD;
+    const size_t barrett    = BARRETT_THRESHOLD;
+    for (const auto &[c, b] : {std::pair<size_t, size_t>{32, 64}, {2, 1000}, {3, 2}, {7, 5}}) {
+        RADIX_CONVERSION_THRESHOLD = c;
+        BARRETT_THRESHOLD          = b;
+        EXPECT_EQ(std::string(BigInt(digits)), digits);
+        EXPECT_EQ(std::string(BigInt("-" + digits)), "-" + digits);
+        EXPECT_EQ(std::string(BigInt(power)), power);
+        EXPECT_EQ(std::string(BigInt(power) - ONE), std::string(2000, '9'));
+    }
+    RADIX_CONVERSION_THRESHOLD = conversion;
+    BARRETT_THRESHOLD          = barrett;
+}
+
 TEST(Constructors, MoveConstructor)
 {
     EXPECT_EQ(BigInt(), BigInt(std::move(BigInt())));
@@ -697,6 +938,10 @@ TEST(PrivateOperators, BitsShiftRight)
     EXPECT_EQ(BigInt(256) >>= -1, ZERO);
     EXPECT_EQ(BigInt(256) >>= 9,  ZERO);
     EXPECT_EQ(BigInt(256) >>= 8,  ONE);
+
+    EXPECT_EQ(BigInt(-256) >>= 8,  BigInt(-1));
+    EXPECT_EQ(BigInt(-257) >>= 1,  BigInt(-129));
+    EXPECT_EQ(BigInt(-1)   >>= 70, BigInt(-1));
 }
 
 TEST(Operators, Div)
@@ -788,6 +1033,92 @@ TEST(Operators, Div)
     }
 }
 
+TEST(Operators, DivMod)
+{
+    EXPECT_THROW(divmod(ONE, ZERO), std::invalid_argument);
+    {
+        const auto [q, r] = divmod(BigInt(-1000), BigInt(13));
+        EXPECT_EQ(q, BigInt(-76));
+        EXPECT_EQ(r, BigInt(-12));
+    }
+    {
+        const auto [q, r] = divmod(BigInt(1000), BigInt(-13));
+        EXPECT_EQ(q, BigInt(-76));
+        EXPECT_EQ(r, BigInt(12));
+    }
+    {
+        const auto [q, r] = divmod(BigInt("1606938044258990275541962092341162602522215339461694069869266"),
+                                   BigInt("-1180591620717411303427"));
+        EXPECT_EQ(q, BigInt("-1361129467683753853850039665213252304896"));
+        EXPECT_EQ(r, BigInt("22721972442696190674"));
+    }
+    {
+        const auto [q, r] = divmod(BigInt("340282366920938463463374607431768211455"),
+                                   BigInt("18446744073709551617"));
+        EXPECT_EQ(q, BigInt(std::to_string(UINT64_MAX)));
+        EXPECT_EQ(r, ZERO);
+    }
+    EXPECT_EQ(BigInt(-1000) % BigInt(-13), BigInt(-12));
+}
+
+TEST(Operators, DivBarrett)
+{
+    const BigInt a(std::string(700, '9'));
+    const BigInt b(std::string(300, '7'));
+    const BigInt c(std::string(299, '5'));
+
+    const size_t barrett = BARRETT_THRESHOLD;
+    for (size_t n : {1, 2, 3, 5, 64}) {
+        BARRETT_THRESHOLD = n;
+        const auto [q, r] = divmod(a * b + c, b);
+        EXPECT_EQ(q, a);
+        EXPECT_EQ(r, c);
+        EXPECT_EQ((a * a - ONE) / (a + ONE), a - ONE);
+        EXPECT_EQ(-(a * a) % (a - ONE), BigInt(-1));
+    }
+    BARRETT_THRESHOLD = barrett;
+}
+
+TEST(Operators, Destination)
+{
+    const BigInt a(std::string(60, '7'));
+    const BigInt b("-" + std::string(45, '3'));
+    BigInt dst;
+
+    add(dst, a, b);
+    EXPECT_EQ(dst, a + b);
+    sub(dst, b, a);
+    EXPECT_EQ(dst, b - a);
+    mul(dst, a, b);
+    EXPECT_EQ(dst, a * b);
+    addmul(dst, b, b);
+    EXPECT_EQ(dst, a * b + b * b);
+    addmul(dst, a, b);
+    EXPECT_EQ(dst, a * b * BigInt(2) + b * b);
+
+    // Destination is same as argument
+    BigInt x(b);
+    sub(x, a, x);
+    EXPECT_EQ(x, a - b);
+    mul(x, x, x);
+    EXPECT_EQ(x, (a - b) * (a - b));
+    addmul(x, x, b);
+    EXPECT_EQ(x, (a - b) * (a - b) * (ONE + b));
+
+    BigInt q(a);
+    BigInt r(b);
+    divmod(q, r, q, r);
+    EXPECT_EQ(q, a / b);
+    EXPECT_EQ(r, a % b);
+    divmod(q, r, b, BigInt(-1000));
+    EXPECT_EQ(q, b / BigInt(-1000));
+    EXPECT_EQ(r, b % BigInt(-1000));
+    divmod(q, r, BigInt(5), b);
+    EXPECT_EQ(q, ZERO);
+    EXPECT_EQ(r, BigInt(5));
+    EXPECT_THROW(divmod(q, r, a, ZERO), std::invalid_argument);
+}
+
 TEST(BitsOperators, Xor)
 {
     EXPECT_EQ(ZERO ^ ZERO, ZERO);
@@ -820,6 +1151,7 @@ TEST(BitsOperators, And)
     EXPECT_EQ(BigInt(60000) & BigInt(450), BigInt(64));
 
     EXPECT_EQ(BigInt(-1) & BigInt(256), BigInt(256));
+    EXPECT_EQ(BigInt(256) & BigInt(-1), BigInt(256));
 }
 
 TEST(BitsOperators, Or)
@@ -839,6 +1171,50 @@ TEST(BitsOperators, Or)
     EXPECT_EQ(BigInt(-1) | BigInt(256), BigInt(-1));
 }
 
+TEST(BitsOperators, Shifts)
+{
+    const BigInt a("-123456789012345678901234567890123456789");
+    const BigInt b("340282366920938463463374607431768211456");     // 2^128
+
+    EXPECT_EQ(ONE << 128, b);
+    EXPECT_EQ(b >> 128, ONE);
+    EXPECT_EQ(b >> 129, ZERO);
+    EXPECT_EQ(ZERO << 1000, ZERO);
+    EXPECT_EQ(BigInt(-3) << 64, BigInt(-3) * (ONE << 64));
+
+    for (size_t shift : {0, 1, 63, 64, 65, 128, 200}) {
+        const BigInt power = ONE << shift;
+        EXPECT_EQ(a << shift, a * power);
+        EXPECT_EQ((a << shift) >> shift, a);
+        // Right shift is rounded down, but division is rounded to zero
+        EXPECT_EQ(a >> shift, (a - power + ONE) / power);
+        EXPECT_EQ(-a >> shift, -a / power);
+    }
+
+    BigInt x(a);
+    x <<= 70;
+    x >>= 6;
+    EXPECT_EQ(x, a << 64);
+    EXPECT_EQ(BigInt(-1) >> 1000, BigInt(-1));
+}
+
+// Number keeps sign and magnitude, but bitwise operators work as with two's complement
+TEST(BitsOperators, NegativeMultiLimb)
+{
+    const BigInt a("-340282366920938463463374607431768211456");    // -2^128
+    const BigInt b("18446744073709551615");                        // 2^64 - 1
+
+    EXPECT_EQ(a & b, ZERO);
+    EXPECT_EQ(a | b, a + b);
+    EXPECT_EQ(a ^ b, a + b);
+    EXPECT_EQ((a - ONE) & (a - ONE), a - ONE);
+    EXPECT_EQ(~a, -a - ONE);
+    EXPECT_EQ((-b) & (-b - ONE), BigInt("-18446744073709551616"));
+    EXPECT_EQ(a ^ a, ZERO);
+    EXPECT_EQ(-ZERO, ZERO);
+    EXPECT_FALSE((a - a).lessZero());
+}
+
 TEST(UnaryOperators, Plus)
 {
     EXPECT_EQ(ZERO, +ZERO);
@@ -866,6 +1242,444 @@ TEST(BoolOperators, EQ)
     EXPECT_FALSE(BigInt(256) == BigInt(255));
 }
 
+TEST(Modular, PowMod)
+{
+    const BigInt a("123456789012345678901234567890");
+    const BigInt p = (ONE << 521) - ONE;                   // Mersenne prime
+    const BigInt e = (ONE << 300) + BigInt(12345);
+
+    EXPECT_EQ(powmod(a, e, p), BigInt("6503362913159548947415706879472252260871521945134995569824763652037357347250996691485262661713372645951315811409375842796516629506407495606313417608659181573"));
+    EXPECT_EQ(powmod(a, p - ONE, p), ONE);
+    EXPECT_EQ(powmod(a + ONE, p - ONE, -p), ONE);
+    EXPECT_EQ(powmod(BigInt("-123456789012345678901234567891"), BigInt(65537), BigInt("10000000000000000000000000000000000000000")),
+              BigInt("1160495079411474854893482152889612039469"));
+
+    // Small powers are compared with repeated multiplication for odd and even moduli
+    for (int m: {1, 2, 7, 12, 97, 1024, 65535}) {
+        BigInt power(ONE % BigInt(m));
+        for (int k = 0; k < 40; k++) {
+            EXPECT_EQ(powmod(BigInt(-3), BigInt(k), BigInt(m)), power);
+            power = (power * BigInt(-3) % BigInt(m) + BigInt(m)) % BigInt(m);
+        }
+    }
+
+    EXPECT_THROW(powmod(a, BigInt(-1), p), std::invalid_argument);
+    EXPECT_THROW(powmod(a, e, ZERO), std::invalid_argument);
+}
+
+TEST(Modular, Montgomery)
+{
+    const BigInt m("340282366920938463463374607431768211507");    // 2^128 + 51
+    const Montgomery context(m);
+    const BigInt a("-98765432109876543210987654321");
+    const BigInt b("123456789012345678901234567890123456789");
+
+    EXPECT_EQ(context.modulus(), m);
+    EXPECT_EQ(context.fromForm(context.toForm(a)), a % m + m);
+    EXPECT_EQ(context.fromForm(context.multiply(context.toForm(a), context.toForm(b))), ((a * b) % m + m) % m);
+    EXPECT_EQ(context.pow(b, ZERO), ONE);
+    EXPECT_EQ(context.pow(b, BigInt(3)), b * b * b % m);
+
+    // Moduli 2^k - 1 with one pass multiplication (below KARATSUBA_THRESHOLD limbs), Karatsuba and its square:
+    // 2^k = 1, so (-2)^e = 2^(e mod k) for even e
+    for (size_t k: {1984, 2048, 2112, 6400}) {
+        const BigInt mersenne((ONE << k) - ONE);
+        const Montgomery longContext(mersenne);
+        const BigInt minusTwo(mersenne - BigInt(2));
+        EXPECT_EQ(longContext.pow(minusTwo, BigInt(int(3 * k + 6))), BigInt(64));
+        EXPECT_EQ(longContext.pow(minusTwo, BigInt(7)), mersenne - BigInt(128));
+        EXPECT_EQ(longContext.fromForm(longContext.multiply(longContext.toForm(minusTwo), longContext.toForm(b))),
+                  (mersenne - b - b) % mersenne);
+    }
+
+    EXPECT_THROW(Montgomery(BigInt(100)), std::invalid_argument);
+    EXPECT_THROW(Montgomery(BigInt(-7)),  std::invalid_argument);
+}
+
+TEST(Modular, Reducer)
+{
+    const BigInt m("-1000000000000000000000000000000000000007");
+    const Reducer reducer(m);
+    const BigInt a("123456789012345678901234567890123456789012345678901234567890123456789");
+
+    EXPECT_EQ(reducer.modulus(), -m);
+    EXPECT_EQ(reducer.reduce(a), a % m);
+    EXPECT_EQ(reducer.reduce(-a), -m - a % m);
+    EXPECT_EQ(reducer.reduce(a * a * a), a * a * a % m);
+    EXPECT_EQ(reducer.reduce(-m), ZERO);
+    EXPECT_EQ(reducer.reduce(BigInt(-5)), -m - BigInt(5));
+    EXPECT_EQ(Reducer(BigInt(1)).reduce(a), ZERO);
+
+    std::vector<BigInt> numbers = {a, -a, ZERO, m, m + ONE, a * a};
+    reducer.reduce(numbers.data(), numbers.size());
+    EXPECT_EQ(numbers, std::vector<BigInt>({a % m, -m - a % m, ZERO, ZERO, ONE, a * a % m}));
+
+    EXPECT_THROW(Reducer(BigInt(0)), std::invalid_argument);
+}
+
+TEST(Modular, Gcd)
+{
+    EXPECT_EQ(gcd(BigInt(12), BigInt(-18)), BigInt(6));
+    EXPECT_EQ(gcd(BigInt(-7), ZERO), BigInt(7));
+    EXPECT_EQ(gcd(ZERO, ZERO), ZERO);
+    EXPECT_EQ(lcm(BigInt(-4), BigInt(6)), BigInt(12));
+    EXPECT_EQ(lcm(BigInt(5), ZERO), ZERO);
+
+    // Long numbers with known common factor go through Lehmer's steps and half gcd
+    const size_t gcdThreshold  = GCD_DC_THRESHOLD;
+    const size_t hgcdThreshold = HGCD_THRESHOLD;
+    GCD_DC_THRESHOLD = 8;
+    HGCD_THRESHOLD   = 4;
+    const BigInt p("170141183460469231731687303715884105727");
+    const BigInt x(powmod(BigInt(3), BigInt(4000), ONE << 5000) + ONE);
+    const BigInt y(powmod(BigInt(5), BigInt(4000), ONE << 5000) + BigInt(3));
+    EXPECT_EQ(gcd(x * p, y * p), gcd(x, y) * p);
+    EXPECT_EQ(gcd(x * p, -(y * p)) % p, ZERO);
+    GCD_DC_THRESHOLD = gcdThreshold;
+    HGCD_THRESHOLD   = hgcdThreshold;
+
+    auto [g, s, t] = xgcd(BigInt(240), BigInt(-46));
+    EXPECT_EQ(g, BigInt(2));
+    EXPECT_EQ(s * BigInt(240) + t * BigInt(-46), g);
+    EXPECT_LE(s * BigInt(2 * 2), BigInt(46));
+
+    auto [g2, s2, t2] = xgcd(x * p, y * p);
+    EXPECT_EQ(s2 * x * p + t2 * y * p, g2);
+
+    EXPECT_EQ(modinv(BigInt(3), BigInt(7)), BigInt(5));
+    EXPECT_EQ(modinv(BigInt(-3), BigInt(-7)), BigInt(2));
+    EXPECT_EQ(modinv(x, p) * x % p, ONE);
+    EXPECT_THROW(modinv(BigInt(4), BigInt(6)), std::invalid_argument);
+    EXPECT_THROW(modinv(BigInt(4), ZERO), std::invalid_argument);
+}
+
+TEST(Roots, Sqrt)
+{
+    EXPECT_EQ(isqrt(ZERO), ZERO);
+    EXPECT_EQ(isqrt(BigInt(3)), ONE);
+    EXPECT_EQ(isqrt(BigInt(4)), BigInt(2));
+    EXPECT_EQ(isqrt(BigInt("18446744073709551615")), BigInt("4294967295"));
+
+    const BigInt x(powmod(BigInt(7), BigInt(5000), ONE << 10000) + ONE);
+    EXPECT_EQ(isqrt(x * x), x);
+    EXPECT_EQ(isqrt(x * x - ONE), x - ONE);
+    EXPECT_EQ(isqrt(x * x + x + x), x);
+
+    EXPECT_TRUE(is_perfect_square(ZERO));
+    EXPECT_TRUE(is_perfect_square(x * x));
+    EXPECT_FALSE(is_perfect_square(x * x + ONE));
+    EXPECT_FALSE(is_perfect_square(BigInt(-4)));
+    EXPECT_THROW(isqrt(BigInt(-1)), std::invalid_argument);
+}
+
+TEST(Roots, Root)
+{
+    EXPECT_EQ(iroot(BigInt(26), 3), BigInt(2));
+    EXPECT_EQ(iroot(BigInt(27), 3), BigInt(3));
+    EXPECT_EQ(iroot(BigInt(-27), 3), BigInt(-3));
+    EXPECT_EQ(iroot(BigInt(1000), 100), ONE);
+    EXPECT_EQ(iroot(BigInt(5), 1), BigInt(5));
+
+    const BigInt x(powmod(BigInt(3), BigInt(1000), ONE << 2000) + ONE);
+    const BigInt cube(x * x * x);
+    EXPECT_EQ(iroot(cube, 3), x);
+    EXPECT_EQ(iroot(cube - ONE, 3), x - ONE);
+    EXPECT_EQ(iroot(-cube, 3), -x);
+    EXPECT_EQ(iroot(cube * cube * x, 7), x);
+
+    EXPECT_THROW(iroot(BigInt(-8), 2), std::invalid_argument);
+    EXPECT_THROW(iroot(BigInt(8), 0), std::invalid_argument);
+}
+
+TEST(Combinatorics, Factorial)
+{
+    EXPECT_EQ(factorial(0), ONE);
+    EXPECT_EQ(factorial(1), ONE);
+    EXPECT_EQ(factorial(20), BigInt("2432902008176640000"));
+    EXPECT_EQ(factorial(25), BigInt("15511210043330985984000000"));
+    EXPECT_EQ(factorial(3000) / factorial(2999), BigInt(3000));
+
+    EXPECT_EQ(binomial(10, 3), BigInt(120));
+    EXPECT_EQ(binomial(10, 11), ZERO);
+    EXPECT_EQ(binomial(7, 7), ONE);
+    EXPECT_EQ(binomial(100, 50), BigInt("100891344545564193334812497256"));
+    EXPECT_EQ(binomial(2000, 700), factorial(2000) / (factorial(700) * factorial(1300)));
+    EXPECT_EQ(binomial(100000, 3), BigInt(100000) * BigInt(99999) * BigInt(99998) / BigInt(6));
+}
+
+TEST(Combinatorics, Fibonacci)
+{
+    EXPECT_EQ(fibonacci(0), ZERO);
+    EXPECT_EQ(fibonacci(1), ONE);
+    EXPECT_EQ(fibonacci(2), ONE);
+    EXPECT_EQ(fibonacci(100), BigInt("354224848179261915075"));
+    EXPECT_EQ(lucas(0), BigInt(2));
+    EXPECT_EQ(lucas(1), ONE);
+    EXPECT_EQ(lucas(100), BigInt("792070839848372253127"));
+
+    EXPECT_EQ(fibonacci(10001), fibonacci(10000) + fibonacci(9999));
+    EXPECT_EQ(lucas(5001), fibonacci(5000) + fibonacci(5002));
+    EXPECT_EQ(fibonacci(6002), fibonacci(3001) * lucas(3001));
+}
+
+TEST(Conversions, Radix)
+{
+    const BigInt x("-255");
+    EXPECT_EQ(to_string(x, 16), "-ff");
+    EXPECT_EQ(to_string(x, 16, true), "-0xff");
+    EXPECT_EQ(to_string(x, 2, true), "-0b11111111");
+    EXPECT_EQ(to_string(x, 8, true), "-0o377");
+    EXPECT_EQ(to_string(x, 36, true), "-73");
+    EXPECT_EQ(to_string(ZERO, 16), "0");
+    EXPECT_EQ(to_string(ZERO, 7), "0");
+    EXPECT_EQ(to_string(BigInt("18446744073709551616"), 16), "10000000000000000");
+    EXPECT_EQ(to_string(BigInt("18446744073709551616"), 32), "g000000000000");
+
+    EXPECT_EQ(from_string("-ff", 16), x);
+    EXPECT_EQ(from_string("-0xFF", 16), x);
+    EXPECT_EQ(from_string("-0XfF", 0), x);
+    EXPECT_EQ(from_string("-0o377", 0), x);
+    EXPECT_EQ(from_string("+0b11111111", 0), -x);
+    EXPECT_EQ(from_string("-255", 0), x);
+    EXPECT_EQ(from_string("0b1", 16), BigInt(177));
+    EXPECT_EQ(from_string("00073", 36), BigInt(255));
+
+    // Long numbers go through power of two pass and through division by powers of base
+    const BigInt y(powmod(BigInt(3), BigInt(100000), ONE << 100000) - (ONE << 50000));
+    for (unsigned base: {2u, 3u, 8u, 10u, 16u, 32u, 36u}) {
+        EXPECT_EQ(from_string(to_string(y, base, true), base), y);
+    }
+    EXPECT_EQ(to_string(y, 10), std::string(y));
+
+    EXPECT_THROW(to_string(x, 37), std::invalid_argument);
+    EXPECT_THROW(from_string("12", 1), std::invalid_argument);
+    EXPECT_THROW(from_string("19", 8), std::invalid_argument);
+    EXPECT_THROW(from_string("-0x", 16), std::invalid_argument);
+    EXPECT_THROW(from_string("", 10), std::invalid_argument);
+}
+
+TEST(Conversions, Bytes)
+{
+    const BigInt x(from_string("-1234567890abcdef0", 16));
+    const LimbView view = x.limbs();
+    EXPECT_EQ(view.size, 2u);
+    EXPECT_TRUE(view.negative);
+    EXPECT_EQ(view[0], 0x234567890abcdef0ULL);
+    EXPECT_EQ(view[1], 1u);
+    EXPECT_EQ(ZERO.limbs().size, 0u);
+
+    EXPECT_EQ(export_size(x), 9u);
+    EXPECT_EQ(export_size(x, true), 9u);
+    EXPECT_EQ(export_size(ZERO), 0u);
+    EXPECT_EQ(export_size(ZERO, true), 1u);
+    EXPECT_EQ(export_size(BigInt(128), true), 2u);
+    EXPECT_EQ(export_size(BigInt(-128), true), 1u);
+
+    std::vector<uchar> bytes(10);
+    export_bytes(bytes.data(), bytes.size(), x, ByteOrder::big);
+    EXPECT_EQ(bytes, std::vector<uchar>({0x00, 0x01, 0x23, 0x45, 0x67, 0x89, 0x0a, 0xbc, 0xde, 0xf0}));
+    EXPECT_EQ(import_bytes(bytes.data(), bytes.size(), ByteOrder::big), -x);
+
+    export_bytes(bytes.data(), bytes.size(), x, ByteOrder::little, true);
+    EXPECT_EQ(bytes, std::vector<uchar>({0x10, 0x21, 0x43, 0xf5, 0x76, 0x98, 0xba, 0xdc, 0xfe, 0xff}));
+    EXPECT_EQ(import_bytes(bytes.data(), bytes.size(), ByteOrder::little, true), x);
+    EXPECT_EQ(import_bytes(bytes.data(), bytes.size(), ByteOrder::little), (ONE << 80) + x);
+
+    const BigInt y(-(ONE << 1000) + BigInt(12345));
+    bytes.resize(export_size(y, true));
+    export_bytes(bytes.data(), bytes.size(), y, ByteOrder::big, true);
+    EXPECT_EQ(import_bytes(bytes.data(), bytes.size(), ByteOrder::big, true), y);
+
+    EXPECT_EQ(import_bytes(bytes.data(), 0), ZERO);
+    EXPECT_THROW(export_bytes(bytes.data(), 8, x), std::invalid_argument);
+}
+
+TEST(Conversions, Stream)
+{
+    std::istringstream in("  12345 -678\n+9x ff -");
+    BigInt x;
+    in >> x;
+    EXPECT_EQ(x, BigInt(12345));
+    in >> x;
+    EXPECT_EQ(x, BigInt(-678));
+    in >> x;
+    EXPECT_EQ(x, BigInt(9));
+    EXPECT_EQ(in.peek(), 'x');
+    in.ignore();
+    in >> std::hex >> x;
+    EXPECT_EQ(x, BigInt(255));
+    in >> x;
+    EXPECT_TRUE(in.fail());
+    EXPECT_EQ(x, BigInt(255));
+
+    // Long numbers are read by many blocks of digits
+    const auto longNumber = [](unsigned base) {
+        std::string digits("-");
+        for (int i = 0; i < 30000; i++) {
+            digits += "0123456789abcdef"[(i * 7 + i / 13) % base];
+        }
+        return from_string(digits, base);
+    };
+    for (unsigned base: {10u, 16u}) {
+        const BigInt y(longNumber(base));
+        std::stringstream stream;
+        stream << (base == 16 ? std::hex : std::dec) << y << ' ' << y + ONE;
+        BigInt z;
+        stream >> z;
+        EXPECT_EQ(z, y);
+        stream >> z;
+        EXPECT_EQ(z, y + ONE);
+        EXPECT_TRUE(stream.eof());
+    }
+
+    const BigInt y(longNumber(7));
+    std::FILE *file = std::tmpfile();
+    std::fputs((to_string(y, 7) + "\n 12 ?").c_str(), file);
+    std::rewind(file);
+    EXPECT_TRUE(read_number(file, x, 7));
+    EXPECT_EQ(x, y);
+    EXPECT_TRUE(read_number(file, x, 7));
+    EXPECT_EQ(x, BigInt(9));
+    EXPECT_FALSE(read_number(file, x, 7));
+    EXPECT_EQ(x, BigInt(9));
+    EXPECT_EQ(std::fgetc(file), '?');
+    std::fclose(file);
+}
+
+TEST(Operators, LongNumbers)
+{
+    // Processor specific kernels must give same results as portable loops, long runs of ones and zeros check carries
+    std::vector<BigInt> numbers;
+    for (size_t bits: {500, 1000, 1024, 1500}) {
+        const BigInt y((ONE << bits) - BigInt(int(bits)));
+        numbers.push_back(y);
+        numbers.push_back(-y);
+        numbers.push_back(y * y + (y << 200));
+        numbers.push_back(-(ONE << bits));
+    }
+    for (const BigInt &a: numbers) {
+        for (const BigInt &b: numbers) {
+            std::vector<BigInt> results[2];
+            for (int simd = 0; simd < 2; simd++) {
+                SIMD_KERNELS = simd;
+                results[simd] = {a + b, a - b, a * b, a / b, a % b,
+                                 a & b, a | b, a ^ b, BigInt(a < b), BigInt(a == b)};
+            }
+            EXPECT_EQ(results[0], results[1]);
+            EXPECT_EQ((a & b) + (a | b), a + b);
+            EXPECT_EQ((a ^ b) | (a & b), a | b);
+        }
+    }
+}
+
+TEST(Conversions, Literal)
+{
+    EXPECT_EQ(0_big, ZERO);
+    EXPECT_EQ(-42_big, BigInt(-42));
+    EXPECT_EQ(123456789012345678901234567890_big, BigInt("123456789012345678901234567890"));
+    EXPECT_EQ(0xffff'ffff'ffff'ffff'ffff_big, (ONE << 80) - ONE);
+    EXPECT_EQ(0B1010_big, BigInt(10));
+    EXPECT_EQ(0777_big, BigInt(511));
+    static_assert(BigLiteral<'1', '8', '4', '4', '6', '7', '4', '4', '0', '7', '3', '7', '0', '9', '5', '5', '1', '6',
+                             '1', '6'>::VIEW.size == 2);
+}
+
+TEST(FixedInt, Constexpr)
+{
+    constexpr Int256 x = (Int256(1) << 200) - Int256(12345);
+    static_assert(x * Int256(3) / Int256(3) == x);
+    static_assert(x % Int256(1000) == Int256(31));
+    static_assert(-x < Int256(0) && UInt256(-1) > UInt256(x.getArray()));
+    static_assert((x >> 190) == Int256(1023) && (-x >> 300) == Int256(-1));
+    static_assert(Int256(-7) / Int256(2) == Int256(-3) && Int256(-7) % Int256(2) == Int256(-1));
+
+    EXPECT_EQ(BigInt(x), (ONE << 200) - BigInt(12345));
+    EXPECT_EQ(std::string(-x), std::string(-BigInt(x)));
+    EXPECT_EQ(Int256(-(ONE << 255)), Int256(1) << 255);
+    EXPECT_EQ(BigInt(Int256(1) << 255), -(ONE << 255));
+    EXPECT_EQ(BigInt(UInt256(1) << 255), ONE << 255);
+    EXPECT_THROW(x / Int256(0), std::invalid_argument);
+}
+
+TEST(FixedInt, Arithmetic)
+{
+    // Results are compared with BigInt taken modulo 2^512
+    const BigInt modulus(ONE << 512);
+    const auto wrap = [&modulus](const BigInt &y) {
+        BigInt forRet(y % modulus);
+        if (forRet < ZERO) {
+            forRet += modulus;
+        }
+        if (forRet >= (modulus >> 1)) {
+            forRet -= modulus;
+        }
+        return forRet;
+    };
+    std::vector<BigInt> numbers;
+    for (size_t bits: {0, 1, 63, 64, 65, 128, 200, 320, 447, 511}) {
+        BigInt y(ONE << bits);
+        y -= BigInt(int(bits * 7919));
+        numbers.push_back(y);
+        numbers.push_back(-y);
+        numbers.push_back(wrap(y * y + BigInt(int(bits))));
+    }
+    for (const BigInt &a: numbers) {
+        const Int512 fa(a);
+        EXPECT_EQ(BigInt(fa), a);
+        for (const BigInt &b: numbers) {
+            const Int512 fb(b);
+            EXPECT_EQ(BigInt(fa + fb), wrap(a + b));
+            EXPECT_EQ(BigInt(fa - fb), wrap(a - b));
+            EXPECT_EQ(BigInt(fa * fb), wrap(a * b));
+            EXPECT_EQ(BigInt(fa & fb), a & b);
+            EXPECT_EQ(fa < fb, a < b);
+            if (b != ZERO && !(a == -(modulus >> 1) && b == -ONE)) {
+                EXPECT_EQ(BigInt(fa / fb), a / b);
+                EXPECT_EQ(BigInt(fa % fb), a % b);
+            }
+        }
+        EXPECT_EQ(BigInt(fa << 100), wrap(a << 100));
+        EXPECT_EQ(BigInt(fa >> 100), a >> 100);
+    }
+}
+
+TEST(Operators, ParallelMultiplication)
+{
+    // Product must not depend on number of threads, low thresholds make Karatsuba, Toom-3,
+    // unbalanced operands and NTT split in parts
+    const size_t threads  = MUL_THREADS;
+    const size_t parallel = PARALLEL_MUL_THRESHOLD;
+    const size_t ntt      = NTT_THRESHOLD;
+    PARALLEL_MUL_THRESHOLD = 40;
+    NTT_THRESHOLD          = 600;
+
+    std::vector<BigInt> numbers;
+    for (size_t n: {4300, 29000, 72000, 150000}) {
+        numbers.push_back(lucas(n));
+    }
+    numbers.push_back(-fibonacci(3000));
+    for (const BigInt &a: numbers) {
+        for (const BigInt &b: numbers) {
+            MUL_THREADS = 1;
+            const BigInt expected(a * b);
+            for (size_t t: {2, 3, 8}) {
+                BigInt product;
+                mul(product, a, b, t);
+                EXPECT_EQ(product, expected);
+                MUL_THREADS = t;
+                EXPECT_EQ(a * b, expected);
+            }
+        }
+    }
+    MUL_THREADS = 4;
+    EXPECT_EQ(numbers[2] * numbers[2], lucas(144000) + BigInt(2));
+    EXPECT_EQ(numbers[3] * numbers[3] / numbers[3], numbers[3]);
+
+    MUL_THREADS            = threads;
+    PARALLEL_MUL_THRESHOLD = parallel;
+    NTT_THRESHOLD          = ntt;
+}
+
 int main()
 {
     testing::InitGoogleTest();